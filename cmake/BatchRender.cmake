@@ -0,0 +1,21 @@
+# Headless batch renderer (tools/BatchRender), runs recordings through the plugin DSP without a DAW
+file (GLOB_RECURSE BatchRenderFiles CONFIGURE_DEPENDS
+      "${CMAKE_CURRENT_SOURCE_DIR}/tools/BatchRender/*.cpp"
+)
+
+source_group (TREE ${CMAKE_CURRENT_SOURCE_DIR}/tools/BatchRender PREFIX "" FILES ${BatchRenderFiles})
+
+juce_add_console_app (PolarDesignerRender PRODUCT_NAME "PolarDesignerRender")
+target_sources (PolarDesignerRender PRIVATE ${BatchRenderFiles})
+target_compile_features (PolarDesignerRender PRIVATE cxx_std_20)
+
+target_compile_definitions (PolarDesignerRender PRIVATE JUCE_WEB_BROWSER=0 JUCE_USE_CURL=0)
+
+# The renderer only uses the GUI-free engine, not the plugin processor
+target_link_libraries (
+    PolarDesignerRender
+    PRIVATE PolarDesignerDsp
+            juce_audio_formats
+            juce::juce_recommended_config_flags
+            juce::juce_recommended_warning_flags
+)
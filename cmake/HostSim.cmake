@@ -0,0 +1,33 @@
+# Headless host simulator (tools/HostSim), replays the DAW_tests regression matrix on the built VST3
+file (GLOB_RECURSE HostSimFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/tools/HostSim/*.cpp")
+
+source_group (TREE ${CMAKE_CURRENT_SOURCE_DIR}/tools/HostSim PREFIX "" FILES ${HostSimFiles})
+
+juce_add_console_app (PolarDesignerHostSim PRODUCT_NAME "PolarDesignerHostSim")
+target_sources (PolarDesignerHostSim PRIVATE ${HostSimFiles})
+target_compile_features (PolarDesignerHostSim PRIVATE cxx_std_20)
+
+# The simulator loads the plugin binary like a DAW, it does not link the plugin code
+target_compile_definitions (
+    PolarDesignerHostSim
+    PRIVATE JUCE_PLUGINHOST_VST3=1
+            JUCE_WEB_BROWSER=0
+            JUCE_USE_CURL=0
+            POLARDESIGNER_ROOT_PATH="${CMAKE_CURRENT_SOURCE_DIR}"
+            POLARDESIGNER_VST3_PATH="$<TARGET_PROPERTY:${PROJECT_NAME}_VST3,JUCE_PLUGIN_ARTEFACT_FILE>"
+)
+
+target_link_libraries (
+    PolarDesignerHostSim
+    PRIVATE juce_audio_formats
+            juce_audio_processors
+            juce::juce_recommended_config_flags
+            juce::juce_recommended_warning_flags
+)
+
+add_dependencies (PolarDesignerHostSim ${PROJECT_NAME}_VST3)
+
+# Only part of ctest once gold references exist, create them with --create-gold-reference
+if (EXISTS "${CMAKE_CURRENT_SOURCE_DIR}/tests/DAW_tests/Reference/HostSim")
+    add_test (NAME HostSimulation COMMAND PolarDesignerHostSim)
+endif ()
@@ -0,0 +1,36 @@
+# GUI-free DSP core (source/dsp), shared by the plugin, the tests and the command line tools
+file (GLOB_RECURSE DspSourceFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/source/dsp/*.h"
+      "${CMAKE_CURRENT_SOURCE_DIR}/source/dsp/*.cpp"
+)
+
+source_group (TREE ${CMAKE_CURRENT_SOURCE_DIR}/source PREFIX "" FILES ${DspSourceFiles})
+
+add_library (PolarDesignerDsp STATIC ${DspSourceFiles})
+target_compile_features (PolarDesignerDsp PUBLIC cxx_std_20)
+set_target_properties (PolarDesignerDsp PROPERTIES POSITION_INDEPENDENT_CODE ON)
+
+# The kernel store, convolver and FFT headers live at the source root
+target_include_directories (PolarDesignerDsp PUBLIC ${CMAKE_CURRENT_SOURCE_DIR}/source)
+
+# JUCE module sources are compiled into the binaries linking this library, otherwise they would
+# end up twice in the plugin. The library itself only needs the module headers.
+target_include_directories (
+    PolarDesignerDsp PRIVATE $<TARGET_PROPERTY:juce_dsp,INTERFACE_INCLUDE_DIRECTORIES>
+)
+target_compile_definitions (
+    PolarDesignerDsp PRIVATE $<TARGET_PROPERTY:juce_dsp,INTERFACE_COMPILE_DEFINITIONS>
+                             JUCE_GLOBAL_MODULE_SETTINGS_INCLUDED=1
+)
+target_link_libraries (
+    PolarDesignerDsp
+    PRIVATE juce::juce_recommended_config_flags juce::juce_recommended_warning_flags
+    INTERFACE juce_audio_basics juce_core juce_data_structures juce_dsp
+)
+
+if (APPLE)
+    target_compile_definitions (PolarDesignerDsp PUBLIC JUCE_USE_VDSP_FRAMEWORK=1)
+    target_link_libraries (PolarDesignerDsp PUBLIC ${ACCELERATE})
+else ()
+    target_compile_definitions (PolarDesignerDsp PUBLIC JUCE_DSP_USE_STATIC_FFTW=1)
+    target_link_libraries (PolarDesignerDsp PUBLIC fftw3f)
+endif ()
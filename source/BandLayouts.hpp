@@ -0,0 +1,139 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <array>
+#include <juce_core/juce_core.h>
+#include <utility>
+
+/* Initial crossover frequencies and crossover ranges for every number of bands */
+struct BandLayout
+{
+    unsigned int numBands = 1;
+    std::array<float, MAX_NUM_BANDS - 1> initXOverHz {};
+    std::array<float, MAX_NUM_BANDS - 1> xOverRangeStartHz {};
+    std::array<float, MAX_NUM_BANDS - 1> xOverRangeEndHz {};
+
+    unsigned int getNumCrossovers() const { return numBands - 1; }
+};
+
+namespace BandLayouts
+{
+// all crossovers lie within this range
+static constexpr float lowestCrossoverHz = 120.0f;
+static constexpr float highestCrossoverHz = 12000.0f;
+
+// hand tuned layouts, sessions store crossovers relative to these ranges, so they stay as is
+static constexpr std::array<std::array<float, 4>, 4> tunedInitXOverHz { {
+    { 1000.0f },
+    { 250.0f, 3000.0f },
+    { 200.0f, 1000.0f, 5000.0f },
+    { 150.0f, 600.0f, 2600.0f, 8000.0f },
+} };
+
+static constexpr std::array<std::array<float, 4>, 4> tunedRangeStartHz { {
+    { 120.0f },
+    { 120.0f, 2000.0f },
+    { 120.0f, 900.0f, 4000.0f },
+    { 120.0f, 500.0f, 2200.0f, 7000.0f },
+} };
+
+static constexpr std::array<std::array<float, 4>, 4> tunedRangeEndHz { {
+    { 12000.0f },
+    { 1000.0f, 12000.0f },
+    { 450.0f, 2500.0f, 12000.0f },
+    { 200.0f, 1100.0f, 4000.0f, 12000.0f },
+} };
+
+static constexpr unsigned int maxTunedBands = 5;
+
+// x^(1 / n) by Newton's method, std::pow is not constexpr
+constexpr double root (double x, int n)
+{
+    double y = 1.0 + (x - 1.0) / n;
+    for (int i = 0; i < 64; ++i)
+    {
+        double power = 1.0;
+        for (int k = 0; k < n - 1; ++k)
+            power *= y;
+        y = ((n - 1) * y + x / power) / n;
+    }
+    return y;
+}
+
+/* Band counts without a tuned layout spread their crossovers evenly on a logarithmic axis.
+ * Each crossover may move by a third of the distance to its neighbours, so adjacent ranges
+ * never overlap.
+ */
+constexpr BandLayout makeLayout (unsigned int numBands)
+{
+    BandLayout layout;
+    layout.numBands = numBands;
+
+    if (numBands < 2)
+        return layout;
+
+    if (numBands <= maxTunedBands)
+    {
+        for (unsigned int i = 0; i + 1 < numBands; ++i)
+        {
+            layout.initXOverHz[i] = tunedInitXOverHz[numBands - 2][i];
+            layout.xOverRangeStartHz[i] = tunedRangeStartHz[numBands - 2][i];
+            layout.xOverRangeEndHz[i] = tunedRangeEndHz[numBands - 2][i];
+        }
+        return layout;
+    }
+
+    const auto n = static_cast<int> (numBands);
+    const auto step = root (highestCrossoverHz / lowestCrossoverHz, n);
+    const auto margin = root (step, 3);
+
+    double f = lowestCrossoverHz;
+    for (unsigned int i = 0; i + 1 < numBands; ++i)
+    {
+        f *= step;
+        layout.initXOverHz[i] = static_cast<float> (f);
+        layout.xOverRangeStartHz[i] = static_cast<float> (f / margin);
+        layout.xOverRangeEndHz[i] = static_cast<float> (f * margin);
+    }
+
+    return layout;
+}
+
+template <size_t... Index>
+constexpr std::array<BandLayout, sizeof...(Index)> makeLayouts (std::index_sequence<Index...>)
+{
+    return { { makeLayout (static_cast<unsigned int> (Index + 1))... } };
+}
+
+// indexed by the number of bands - 1
+static constexpr auto all = makeLayouts (std::make_index_sequence<MAX_NUM_BANDS>());
+} // namespace BandLayouts
+
+inline const BandLayout& getBandLayout (unsigned int numBands)
+{
+    jassert (numBands >= 1 && numBands <= MAX_NUM_BANDS);
+    return BandLayouts::all[numBands - 1];
+}
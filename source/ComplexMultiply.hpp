@@ -0,0 +1,130 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <juce_core/juce_core.h>
+
+#if JUCE_INTEL
+    #include <immintrin.h>
+#endif
+
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+    #define PD_TARGET_SSE3 __attribute__ ((target ("sse3")))
+    #define PD_TARGET_AVX2 __attribute__ ((target ("avx2,fma")))
+#else
+    #define PD_TARGET_SSE3
+    #define PD_TARGET_AVX2
+#endif
+
+/* Interleaved complex multiply-accumulate (acc += a * b) of half spectra as used by the
+ * partitioned convolution. The widest variant the CPU supports is picked once at runtime,
+ * so the binary itself doesn't need to be built for a particular instruction set.
+ */
+using ComplexMultiplyAccumulateFn = void (*) (float* acc,
+                                              const float* a,
+                                              const float* b,
+                                              size_t numBins);
+
+static inline void complexMultiplyAccumulateScalar (float* acc,
+                                                    const float* a,
+                                                    const float* b,
+                                                    size_t numBins)
+{
+    for (size_t i = 0; i < numBins; ++i)
+    {
+        const auto ar = a[2 * i], ai = a[2 * i + 1];
+        const auto br = b[2 * i], bi = b[2 * i + 1];
+        acc[2 * i] += ar * br - ai * bi;
+        acc[2 * i + 1] += ar * bi + ai * br;
+    }
+}
+
+#if JUCE_INTEL
+PD_TARGET_SSE3 static inline void complexMultiplyAccumulateSSE3 (float* acc,
+                                                                 const float* a,
+                                                                 const float* b,
+                                                                 size_t numBins)
+{
+    size_t i = 0;
+    for (; i + 2 <= numBins; i += 2)
+    {
+        const auto va = _mm_loadu_ps (a + 2 * i);
+        const auto vb = _mm_loadu_ps (b + 2 * i);
+        const auto bRe = _mm_moveldup_ps (vb);
+        const auto bIm = _mm_movehdup_ps (vb);
+        const auto aSwapped = _mm_shuffle_ps (va, va, _MM_SHUFFLE (2, 3, 0, 1));
+
+        // (ar * br - ai * bi, ai * br + ar * bi)
+        const auto product = _mm_addsub_ps (_mm_mul_ps (va, bRe), _mm_mul_ps (aSwapped, bIm));
+        _mm_storeu_ps (acc + 2 * i, _mm_add_ps (_mm_loadu_ps (acc + 2 * i), product));
+    }
+
+    complexMultiplyAccumulateScalar (acc + 2 * i, a + 2 * i, b + 2 * i, numBins - i);
+}
+
+PD_TARGET_AVX2 static inline void complexMultiplyAccumulateAVX2 (float* acc,
+                                                                 const float* a,
+                                                                 const float* b,
+                                                                 size_t numBins)
+{
+    size_t i = 0;
+    for (; i + 4 <= numBins; i += 4)
+    {
+        const auto va = _mm256_loadu_ps (a + 2 * i);
+        const auto vb = _mm256_loadu_ps (b + 2 * i);
+        const auto bRe = _mm256_moveldup_ps (vb);
+        const auto bIm = _mm256_movehdup_ps (vb);
+        const auto aSwapped = _mm256_permute_ps (va, _MM_SHUFFLE (2, 3, 0, 1));
+
+        const auto product = _mm256_fmaddsub_ps (va, bRe, _mm256_mul_ps (aSwapped, bIm));
+        _mm256_storeu_ps (acc + 2 * i, _mm256_add_ps (_mm256_loadu_ps (acc + 2 * i), product));
+    }
+
+    complexMultiplyAccumulateScalar (acc + 2 * i, a + 2 * i, b + 2 * i, numBins - i);
+}
+#endif
+
+struct ComplexMultiplyAccumulate
+{
+    ComplexMultiplyAccumulateFn function;
+    const char* name;
+};
+
+/* Resolved once per process */
+inline const ComplexMultiplyAccumulate& getComplexMultiplyAccumulate()
+{
+    static const ComplexMultiplyAccumulate selected = []() -> ComplexMultiplyAccumulate
+    {
+#if JUCE_INTEL
+        if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3())
+            return { complexMultiplyAccumulateAVX2, "AVX2" };
+
+        if (juce::SystemStats::hasSSE3())
+            return { complexMultiplyAccumulateSSE3, "SSE3" };
+#endif
+        return { complexMultiplyAccumulateScalar, "Scalar" };
+    }();
+
+    return selected;
+}
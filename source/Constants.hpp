@@ -24,26 +24,35 @@
 
 static constexpr int PD_DEFAULT_BLOCK_SIZE = 1024;
 
-/* PolarDesigner has a maximum of 5 EQ's .. */
+/* Host blocks are processed in sub-blocks of at most this many samples, which also sets the
+ * convolver partition size. Smaller quanta keep the working set in cache, larger ones need
+ * fewer FFTs per sample. */
+static constexpr int PD_DEFAULT_PROCESSING_QUANTUM = 1024;
+
+/* Offline renders have no deadline, so throughput is all that counts: partitions as long as
+ * the longest kernels need a single segment and the fewest FFTs. At 192 kHz the filter bank
+ * kernels take 1605 taps at standard and 3205 at high quality. */
+static constexpr int PD_OFFLINE_PROCESSING_QUANTUM = 4096;
+
+/* Handing work to another core costs a few microseconds, more when the worker has to be woken
+ * up. Independent convolutions only run in parallel when the ones handed off take at least
+ * this many flops per quantum, about 20 us on a single core. */
+static constexpr float PD_PARALLEL_WORK_THRESHOLD = 100000.0f;
+
+/* The plugin exposes a maximum of 5 EQ's (bands) .. */
 static constexpr unsigned int MAX_NUM_EQS = 5;
+/* .. the DSP engine and the filter bank design handle up to 8. The plugin parameters, presets
+ * and the editor stop at MAX_NUM_EQS, bands 6 to 8 are only reachable through
+ * PolarDesignerDsp::Parameters for now .. */
+static constexpr unsigned int MAX_NUM_BANDS = 8;
 /* .. and functions on a maximum of 2 inputs only. */
 static constexpr int MAX_NUM_INPUTS = 2;
 
-// initial xover frequencies for several numbers of bands
-static constexpr float INIT_XOVER_FREQS_2B[1] = { 1000.0f };
-static constexpr float INIT_XOVER_FREQS_3B[2] = { 250.0f, 3000.0f };
-static constexpr float INIT_XOVER_FREQS_4B[3] = { 200.0f, 1000.0f, 5000.0f };
-static constexpr float INIT_XOVER_FREQS_5B[4] = { 150.0f, 600.0f, 2600.0f, 8000.0f };
-
-// xover ranges for several numbers of bands
-static constexpr float XOVER_RANGE_START_2B[1] = { 120.0f };
-static constexpr float XOVER_RANGE_END_2B[1] = { 12000.0f };
-static constexpr float XOVER_RANGE_START_3B[2] = { 120.0f, 2000.0f };
-static constexpr float XOVER_RANGE_END_3B[2] = { 1000.0f, 12000.0f };
-static constexpr float XOVER_RANGE_START_4B[3] = { 120.0f, 900.0f, 4000.0f };
-static constexpr float XOVER_RANGE_END_4B[3] = { 450.0f, 2500.0f, 12000.0f };
-static constexpr float XOVER_RANGE_START_5B[4] = { 120.0f, 500.0f, 2200.0f, 7000.0f };
-static constexpr float XOVER_RANGE_END_5B[4] = { 200.0f, 1100.0f, 4000.0f, 12000.0f };
+static_assert (MAX_NUM_EQS <= MAX_NUM_BANDS);
+
+/* Multi-pair layouts take 2 N inputs, one capsule pair after the other, and give one virtual
+ * microphone per pair. */
+static constexpr int MAX_NUM_PAIRS = 8;
 
 // TODO: check if this is a duplicate of MAX_NUM_INPUTS
 static constexpr int N_CH_IN = 2;
@@ -51,6 +60,21 @@ static constexpr int N_CH_IN = 2;
 static constexpr int FILTER_BANK_NATIVE_SAMPLE_RATE = 48000;
 static constexpr int FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE = 401;
 
+/* Filter bank quality tiers: longer kernels give steeper crossovers at the cost of latency
+ * and CPU. Standard is the original design. */
+enum class FilterBankQuality
+{
+    eco,
+    standard,
+    high
+};
+static constexpr int NUM_FILTER_BANK_QUALITIES = 3;
+static constexpr int FILTER_BANK_IR_LENGTHS_AT_NATIVE_SAMPLE_RATE[NUM_FILTER_BANK_QUALITIES] = {
+    201,
+    FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE,
+    801
+};
+
 static constexpr int DF_EQ_LEN = 512;
 static constexpr int FF_EQ_LEN = 512;
 static constexpr int EQ_SAMPLE_RATE = 48000;
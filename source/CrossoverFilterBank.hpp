@@ -0,0 +1,168 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <array>
+#include <cmath>
+#include <juce_dsp/juce_dsp.h>
+
+/* Minimum phase filter bank of the zero latency mode, a cascade of 4th order Linkwitz-Riley
+ * crossovers. Crossover k splits the highpass output of crossover k - 1, its lowpass output is
+ * band k. Every band below a crossover runs through the allpass of that crossover, so the
+ * phases line up and all bands add up to an allpass, without any latency.
+ *
+ * The filters are recursive and cheap per sample, in contrast to the linear phase FIRs their
+ * coefficients can follow crossover changes right away, there is nothing to design.
+ */
+class CrossoverFilterBank
+{
+public:
+    using Filter = juce::dsp::LinkwitzRileyFilter<float>;
+
+    void prepare (double newSampleRate, int numChannels)
+    {
+        sampleRate = newSampleRate;
+
+        const juce::dsp::ProcessSpec spec {
+            sampleRate, 1, static_cast<juce::uint32> (numChannels)
+        };
+        for (size_t k = 0; k < maxCrossovers; ++k)
+        {
+            crossovers[k].setType (juce::dsp::LinkwitzRileyFilterType::lowpass);
+            crossovers[k].prepare (spec);
+
+            for (size_t j = 0; j < k; ++j)
+            {
+                allpasses[j][k].setType (juce::dsp::LinkwitzRileyFilterType::allpass);
+                allpasses[j][k].prepare (spec);
+            }
+        }
+
+        numBands = 1;
+        xOverHz.fill (0.0f);
+    }
+
+    void reset()
+    {
+        for (size_t k = 0; k < maxCrossovers; ++k)
+        {
+            crossovers[k].reset();
+            for (size_t j = 0; j < k; ++j)
+                allpasses[j][k].reset();
+        }
+    }
+
+    // the filter states are kept as long as the number of bands stays the same
+    void setCrossovers (unsigned int newNumBands,
+                        const std::array<float, MAX_NUM_BANDS - 1>& newXOverHz)
+    {
+        jassert (newNumBands >= 1 && newNumBands <= MAX_NUM_BANDS);
+
+        if (newNumBands != numBands)
+        {
+            numBands = newNumBands;
+            reset();
+        }
+
+        for (size_t k = 0; k + 1 < numBands; ++k)
+        {
+            if (juce::exactlyEqual (newXOverHz[k], xOverHz[k]))
+                continue;
+
+            xOverHz[k] = newXOverHz[k];
+            const auto cutoff =
+                juce::jlimit (10.0f, static_cast<float> (0.45 * sampleRate), xOverHz[k]);
+
+            crossovers[k].setCutoffFrequency (cutoff);
+            for (size_t j = 0; j < k; ++j)
+                allpasses[j][k].setCutoffFrequency (cutoff);
+        }
+    }
+
+    unsigned int getNumBands() const { return numBands; }
+
+    // the filters decay by more than 120 dB within four periods of the lowest crossover
+    int getTailLength() const
+    {
+        if (numBands < 2)
+            return 0;
+
+        const auto lowest = juce::jmax (10.0f, xOverHz[0]);
+        return static_cast<int> (std::ceil (4.0 * sampleRate / lowest));
+    }
+
+    /* Splits one channel into getNumBands() bands, input must not alias any of the bands.
+     * Different channels may be processed on different threads at the same time.
+     */
+    void process (int channel, const float* input, float* const* bands, size_t numSamples)
+    {
+        const auto* rest = input;
+
+        for (size_t k = 0; k + 1 < numBands; ++k)
+        {
+            // the highpass part is split further by the next crossover, in place
+            auto* low = bands[k];
+            auto* high = bands[k + 1];
+            auto& crossover = crossovers[k];
+            for (size_t i = 0; i < numSamples; ++i)
+                crossover.processSample (channel, rest[i], low[i], high[i]);
+            rest = high;
+
+            for (size_t j = 0; j < k; ++j)
+            {
+                auto* band = bands[j];
+                auto& allpass = allpasses[j][k];
+                for (size_t i = 0; i < numSamples; ++i)
+                    band[i] = allpass.processSample (channel, band[i]);
+            }
+        }
+
+        if (numBands == 1)
+            std::copy_n (input, numSamples, bands[0]);
+    }
+
+    // flushes decaying states of all channels to zero, so silence stays silence
+    void snapToZero()
+    {
+        for (size_t k = 0; k + 1 < numBands; ++k)
+        {
+            crossovers[k].snapToZero();
+            for (size_t j = 0; j < k; ++j)
+                allpasses[j][k].snapToZero();
+        }
+    }
+
+private:
+    static constexpr size_t maxCrossovers = MAX_NUM_BANDS - 1;
+
+    double sampleRate = FILTER_BANK_NATIVE_SAMPLE_RATE;
+    unsigned int numBands = 1;
+    std::array<float, MAX_NUM_BANDS - 1> xOverHz {};
+
+    std::array<Filter, maxCrossovers> crossovers;
+
+    // allpasses[j][k] aligns band j to crossover k, only j < k is used
+    std::array<std::array<Filter, maxCrossovers>, maxCrossovers> allpasses;
+};
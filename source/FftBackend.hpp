@@ -0,0 +1,595 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "Logging.hpp"
+
+#include <atomic>
+#include <juce_data_structures/juce_data_structures.h>
+#include <juce_dsp/juce_dsp.h>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#if JUCE_DSP_USE_STATIC_FFTW
+// FFTW is linked statically, these are the same entry points juce_dsp declares for its engine
+extern "C"
+{
+    void* fftwf_malloc (size_t);
+    void fftwf_free (void*);
+    void* fftwf_plan_dft_r2c_1d (int, void*, void*, unsigned int);
+    void* fftwf_plan_dft_c2r_1d (int, void*, void*, unsigned int);
+    void fftwf_destroy_plan (void*);
+    void fftwf_execute_dft_r2c (void*, void*, void*);
+    void fftwf_execute_dft_c2r (void*, void*, void*);
+    void fftwf_set_timelimit (double);
+    int fftwf_import_wisdom_from_string (const char*);
+    char* fftwf_export_wisdom_to_string();
+    extern const char fftwf_version[];
+}
+#endif
+
+enum class FftBackendType
+{
+    juce, // juce::dsp::FFT, whatever engine JUCE was built with (vDSP on macOS)
+    fftw // FFTW plans used directly, FFTW picks its SIMD codelets at runtime
+};
+
+/* Real FFT as used by the partitioned convolution: fftSize real samples in, numBins
+ * interleaved complex values out, unnormalised forward and 1 / fftSize scaled inverse.
+ * Time and frequency data may share memory, so the source of a transform is undefined
+ * after it has been executed.
+ */
+class FftBackend
+{
+public:
+    explicit FftBackend (size_t size) : fftSize (size), numBins (size / 2 + 1)
+    {
+        jassert (juce::isPowerOfTwo (size));
+    }
+
+    virtual ~FftBackend() = default;
+
+    virtual float* getTimeData() = 0;
+    virtual float* getFrequencyData() = 0;
+
+    virtual void forward() = 0;
+    virtual void inverse() = 0;
+
+    virtual FftBackendType getType() const = 0;
+
+    static std::unique_ptr<FftBackend> create (FftBackendType type, size_t fftSize);
+
+    /* Creates the backend that was measured fastest for this size */
+    static std::unique_ptr<FftBackend> createFastest (size_t fftSize)
+    {
+        return create (getFastestType (fftSize), fftSize);
+    }
+
+    static FftBackendType getFastestType (size_t fftSize);
+
+    static std::vector<FftBackendType> getAvailableTypes()
+    {
+#if JUCE_DSP_USE_STATIC_FFTW
+        return { FftBackendType::juce, FftBackendType::fftw };
+#else
+        return { FftBackendType::juce };
+#endif
+    }
+
+    static const char* getName (FftBackendType type)
+    {
+        switch (type)
+        {
+            case FftBackendType::juce:
+                return "JUCE";
+            case FftBackendType::fftw:
+                return "FFTW";
+        }
+        return "unknown";
+    }
+
+    const size_t fftSize, numBins;
+
+    /* The FFTW planner (also used by juce::dsp::FFT with its FFTW engine) isn't thread
+     * safe, every plan creation and destruction has to hold this lock.
+     */
+    static std::mutex& getPlannerMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (FftBackend)
+};
+
+//==============================================================================
+class JuceFftBackend final : public FftBackend
+{
+public:
+    explicit JuceFftBackend (size_t size) : FftBackend (size), buffer (2 * size, 0.0f)
+    {
+        const std::lock_guard<std::mutex> lock (getPlannerMutex());
+        fft = std::make_unique<juce::dsp::FFT> (static_cast<int> (std::log2 (size)));
+    }
+
+    ~JuceFftBackend() override
+    {
+        const std::lock_guard<std::mutex> lock (getPlannerMutex());
+        fft.reset();
+    }
+
+    float* getTimeData() override { return buffer.data(); }
+    float* getFrequencyData() override { return buffer.data(); }
+
+    void forward() override { fft->performRealOnlyForwardTransform (buffer.data(), true); }
+
+    void inverse() override
+    {
+        // restore the negative frequencies for FFT engines that expect a full spectrum
+        for (size_t i = numBins; i < fftSize; ++i)
+        {
+            buffer[2 * i] = buffer[2 * (fftSize - i)];
+            buffer[2 * i + 1] = -buffer[2 * (fftSize - i) + 1];
+        }
+
+        fft->performRealOnlyInverseTransform (buffer.data());
+    }
+
+    FftBackendType getType() const override { return FftBackendType::juce; }
+
+private:
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> buffer;
+};
+
+#if JUCE_DSP_USE_STATIC_FFTW
+//==============================================================================
+/* Owns the FFTW plans of the process and the persistent wisdom they are created from.
+ *
+ * Plans are created once per size and shared by all backends, they are executed on the
+ * backend's own (equally aligned) buffers. Without wisdom a cheap estimated plan is used
+ * right away and a patient plan is measured on a background thread; the result ends up in
+ * the wisdom file in the AustrianAudio settings folder, so later sessions get the patient
+ * plans without planning again. Backends hold a reference, which keeps the plans alive.
+ *
+ * Cached plans are handed out without touching the FFTW planner. The patient planning runs
+ * in short slices and lets new instances plan in between, so it never holds the planner
+ * lock for more than a slice.
+ */
+class FftwPlanner : private juce::Thread
+{
+public:
+    struct Plans
+    {
+        void* forward = nullptr;
+        void* inverse = nullptr;
+    };
+
+    FftwPlanner() : juce::Thread ("FFTW planner")
+    {
+        static std::once_flag wisdomLoaded;
+        std::call_once (wisdomLoaded, [] { importWisdom (getWisdomFile()); });
+    }
+
+    ~FftwPlanner() override
+    {
+        stopThread (static_cast<int> (sliceTimeLimitSeconds * 1000) + 1000);
+
+        const std::lock_guard<std::mutex> lock (FftBackend::getPlannerMutex());
+        for (auto& [size, p] : plans)
+            destroy (p);
+        for (auto& p : retiredPlans)
+            destroy (p);
+    }
+
+    Plans get (size_t fftSize)
+    {
+        if (const auto cached = findPlans (fftSize))
+            return *cached;
+
+        // plans of one size are only created once
+        const std::lock_guard<std::mutex> creation (creationLock);
+        if (const auto cached = findPlans (fftSize))
+            return *cached;
+
+        Plans p;
+        bool fromWisdom = false;
+        {
+            // the patient planning lets go of the planner between its slices
+            const ScopedPlannerRequest request (*this);
+            const std::lock_guard<std::mutex> lock (FftBackend::getPlannerMutex());
+            p = create (fftSize, wisdomOnly | patient);
+            fromWisdom = p.forward != nullptr;
+            if (! fromWisdom)
+                p = create (fftSize, estimate);
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock (plansLock);
+            plans[fftSize] = p;
+        }
+
+        if (! fromWisdom && p.forward != nullptr)
+        {
+            {
+                const juce::ScopedLock sl (pendingLock);
+                pendingSizes.addIfNotAlreadyThere (fftSize);
+            }
+            startThread (juce::Thread::Priority::background);
+            notify();
+        }
+        return p;
+    }
+
+    /* Where the wisdom is loaded from and saved to, the settings folder unless set otherwise.
+     * An invalid file keeps the wisdom in memory only, e.g. for tests. Set it before the
+     * first FFTW backend is created.
+     */
+    static void setWisdomFile (const juce::File& file)
+    {
+        const std::lock_guard<std::mutex> lock (getWisdomFileMutex());
+        getWisdomFileStorage() = file;
+    }
+
+    static juce::File getWisdomFile()
+    {
+        const std::lock_guard<std::mutex> lock (getWisdomFileMutex());
+        return getWisdomFileStorage();
+    }
+
+    /* Wisdom is only accepted if it was written by the same FFTW build on the same CPU and
+     * the content matches its checksum. Returns false if nothing was imported.
+     */
+    static bool importWisdom (const juce::File& file)
+    {
+        if (! file.existsAsFile())
+            return false;
+
+        auto lines = juce::StringArray::fromLines (file.loadFileAsString());
+        if (lines.size() < headerLines || lines[0] != fileTag || lines[1] != getSystemTag())
+        {
+            LOG_WARN ("Ignoring FFTW wisdom from another system: " + file.getFullPathName());
+            return false;
+        }
+
+        const auto checksum = lines[2];
+        lines.removeRange (0, headerLines);
+        const auto wisdom = lines.joinIntoString ("\n");
+
+        if (checksum != getChecksum (wisdom))
+        {
+            LOG_ERROR ("Corrupted FFTW wisdom file: " + file.getFullPathName());
+            return false;
+        }
+
+        const std::lock_guard<std::mutex> lock (FftBackend::getPlannerMutex());
+        return fftwf_import_wisdom_from_string (wisdom.toRawUTF8()) != 0;
+    }
+
+    static bool exportWisdom (const juce::File& file)
+    {
+        if (file == juce::File())
+            return false;
+
+        juce::String wisdom;
+        {
+            const std::lock_guard<std::mutex> lock (FftBackend::getPlannerMutex());
+            if (auto* exported = fftwf_export_wisdom_to_string())
+            {
+                wisdom = juce::String (exported).trimEnd();
+                free (exported);
+            }
+        }
+
+        if (wisdom.isEmpty())
+            return false;
+
+        const auto content = juce::StringArray { fileTag, getSystemTag(), getChecksum (wisdom), wisdom }
+                                 .joinIntoString ("\n");
+
+        // other processes might read the file at the same time, only replace it when complete
+        file.getParentDirectory().createDirectory();
+        juce::TemporaryFile temp (file);
+        if (! temp.getFile().replaceWithText (content) || ! temp.overwriteTargetFileWithTemporary())
+        {
+            LOG_ERROR ("Could not write FFTW wisdom file: " + file.getFullPathName());
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            size_t fftSize = 0;
+            {
+                const juce::ScopedLock sl (pendingLock);
+                if (! pendingSizes.isEmpty())
+                    fftSize = pendingSizes.removeAndReturn (0);
+            }
+
+            if (fftSize == 0)
+            {
+                wait (-1);
+                continue;
+            }
+
+            const auto patientPlans = planPatiently (fftSize);
+            if (patientPlans.forward == nullptr)
+                continue;
+
+            {
+                // backends created so far keep using the old plans
+                const std::lock_guard<std::mutex> lock (plansLock);
+                retiredPlans.push_back (plans[fftSize]);
+                plans[fftSize] = patientPlans;
+            }
+
+            exportWisdom (getWisdomFile());
+        }
+    }
+
+    /* FFTW keeps the wisdom of all sub-problems it has measured, also when a slice runs out
+     * of time, so every slice continues where the last one stopped. A slice that finishes
+     * within its time limit has found the patient plan.
+     */
+    Plans planPatiently (size_t fftSize)
+    {
+        for (int slice = 0; slice < maxSlices && ! threadShouldExit(); ++slice)
+        {
+            // new instances plan first, they are waiting for it
+            while (numPlannerRequests.load() > 0 && ! threadShouldExit())
+                wait (1);
+
+            const std::lock_guard<std::mutex> lock (FftBackend::getPlannerMutex());
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            fftwf_set_timelimit (sliceTimeLimitSeconds);
+            auto p = create (fftSize, patient);
+            fftwf_set_timelimit (-1.0); // FFTW_NO_TIMELIMIT
+
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+            if (seconds < 0.5 * sliceTimeLimitSeconds || slice + 1 == maxSlices)
+                return p;
+
+            destroy (p);
+        }
+        return {};
+    }
+
+    std::optional<Plans> findPlans (size_t fftSize)
+    {
+        const std::lock_guard<std::mutex> lock (plansLock);
+        if (const auto it = plans.find (fftSize); it != plans.end())
+            return it->second;
+        return std::nullopt;
+    }
+
+    // announces a plan request of a new instance to the patient planning
+    struct ScopedPlannerRequest
+    {
+        explicit ScopedPlannerRequest (FftwPlanner& p) : planner (p)
+        {
+            ++planner.numPlannerRequests;
+        }
+        ~ScopedPlannerRequest() { --planner.numPlannerRequests; }
+
+        FftwPlanner& planner;
+    };
+
+    static std::mutex& getWisdomFileMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static juce::File& getWisdomFileStorage()
+    {
+        static juce::File file = []
+        {
+            juce::PropertiesFile::Options options;
+            options.applicationName = "PolarDesigner";
+            options.filenameSuffix = "wisdom";
+            options.folderName = "AustrianAudio";
+            options.osxLibrarySubFolder = "Preferences";
+            return options.getDefaultFile();
+        }();
+        return file;
+    }
+
+    static Plans create (size_t fftSize, unsigned int flags)
+    {
+        // planning other than FFTW_ESTIMATE overwrites the arrays, so plan on scratch memory
+        auto* time = static_cast<float*> (fftwf_malloc (fftSize * sizeof (float)));
+        auto* freq = static_cast<float*> (fftwf_malloc ((fftSize + 2) * sizeof (float)));
+
+        Plans p;
+        p.forward = fftwf_plan_dft_r2c_1d (static_cast<int> (fftSize), time, freq, flags);
+        p.inverse = fftwf_plan_dft_c2r_1d (static_cast<int> (fftSize), freq, time, flags);
+
+        fftwf_free (time);
+        fftwf_free (freq);
+
+        if (p.forward == nullptr || p.inverse == nullptr)
+        {
+            destroy (p);
+            return {};
+        }
+
+        return p;
+    }
+
+    static void destroy (Plans& p)
+    {
+        if (p.forward != nullptr)
+            fftwf_destroy_plan (p.forward);
+        if (p.inverse != nullptr)
+            fftwf_destroy_plan (p.inverse);
+        p = {};
+    }
+
+    static juce::String getSystemTag()
+    {
+        return juce::String (fftwf_version) + " " + juce::SystemStats::getCpuModel();
+    }
+
+    static juce::String getChecksum (const juce::String& wisdom)
+    {
+        return juce::String::toHexString (wisdom.hashCode64());
+    }
+
+    static constexpr unsigned int patient = 1U << 5; // FFTW_PATIENT
+    static constexpr unsigned int estimate = 1U << 6; // FFTW_ESTIMATE
+    static constexpr unsigned int wisdomOnly = 1U << 21; // FFTW_WISDOM_ONLY
+    // 25 slices of 0.2 s, the 5 s the patient planning had before
+    static constexpr double sliceTimeLimitSeconds = 0.2;
+    static constexpr int maxSlices = 25;
+
+    static constexpr const char* fileTag = "PolarDesigner FFTW wisdom v1";
+    static constexpr int headerLines = 3;
+
+    std::mutex creationLock; // held while new plans are created, not for cached ones
+    std::mutex plansLock; // guards plans and retiredPlans, never held while planning
+    std::map<size_t, Plans> plans;
+    std::vector<Plans> retiredPlans;
+    std::atomic<int> numPlannerRequests { 0 };
+
+    juce::CriticalSection pendingLock;
+    juce::Array<size_t> pendingSizes;
+};
+
+class FftwBackend final : public FftBackend
+{
+public:
+    explicit FftwBackend (size_t size) :
+        FftBackend (size),
+        plans (planner->get (size)),
+        time (static_cast<float*> (fftwf_malloc (size * sizeof (float)))),
+        freq (static_cast<float*> (fftwf_malloc (2 * numBins * sizeof (float)))),
+        scale (1.0f / static_cast<float> (size))
+    {
+        std::fill_n (time, fftSize, 0.0f);
+        std::fill_n (freq, 2 * numBins, 0.0f);
+    }
+
+    ~FftwBackend() override
+    {
+        fftwf_free (time);
+        fftwf_free (freq);
+    }
+
+    float* getTimeData() override { return time; }
+    float* getFrequencyData() override { return freq; }
+
+    void forward() override { fftwf_execute_dft_r2c (plans.forward, time, freq); }
+
+    void inverse() override
+    {
+        fftwf_execute_dft_c2r (plans.inverse, freq, time);
+        juce::FloatVectorOperations::multiply (time, scale, static_cast<int> (fftSize));
+    }
+
+    FftBackendType getType() const override { return FftBackendType::fftw; }
+
+private:
+    juce::SharedResourcePointer<FftwPlanner> planner;
+    const FftwPlanner::Plans plans;
+    float* const time;
+    float* const freq;
+    const float scale;
+};
+#endif
+
+//==============================================================================
+inline std::unique_ptr<FftBackend> FftBackend::create (FftBackendType type, size_t fftSize)
+{
+#if JUCE_DSP_USE_STATIC_FFTW
+    if (type == FftBackendType::fftw)
+        return std::make_unique<FftwBackend> (fftSize);
+#endif
+    juce::ignoreUnused (type);
+    return std::make_unique<JuceFftBackend> (fftSize);
+}
+
+/* Runs a short forward/inverse benchmark of every available backend the first time a size
+ * is requested, the choice is kept for the lifetime of the process.
+ */
+inline FftBackendType FftBackend::getFastestType (size_t fftSize)
+{
+    static std::mutex mutex;
+    static std::map<size_t, FftBackendType> fastest;
+
+    const std::lock_guard<std::mutex> lock (mutex);
+
+    if (const auto it = fastest.find (fftSize); it != fastest.end())
+        return it->second;
+
+    const auto types = getAvailableTypes();
+    auto best = types.front();
+
+    if (types.size() > 1)
+    {
+        const auto iterations = std::max<size_t> (16, (size_t { 1 } << 17) / fftSize);
+        auto bestTicks = std::numeric_limits<juce::int64>::max();
+
+        for (const auto type : types)
+        {
+            auto fft = create (type, fftSize);
+
+            juce::Random random (1);
+            for (size_t i = 0; i < fftSize; ++i)
+                fft->getTimeData()[i] = random.nextFloat() - 0.5f;
+
+            // forward followed by inverse is an identity, so the data stays bounded
+            auto ticks = std::numeric_limits<juce::int64>::max();
+            for (int run = 0; run < 3; ++run)
+            {
+                const auto start = juce::Time::getHighResolutionTicks();
+                for (size_t i = 0; i < iterations; ++i)
+                {
+                    fft->forward();
+                    fft->inverse();
+                }
+                ticks = std::min (ticks, juce::Time::getHighResolutionTicks() - start);
+            }
+
+            LOG_DEBUG ("FFT size " + juce::String (fftSize) + ": " + getName (type) + " took "
+                       + juce::String (ticks) + " ticks");
+
+            if (ticks < bestTicks)
+            {
+                bestTicks = ticks;
+                best = type;
+            }
+        }
+    }
+
+    fastest[fftSize] = best;
+    return best;
+}
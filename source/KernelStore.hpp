@@ -0,0 +1,662 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "Constants.hpp"
+#include "FilterCoefficients.hpp"
+#include "PartitionedConvolver.hpp"
+
+#include <array>
+#include <atomic>
+#include <juce_dsp/juce_dsp.h>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// everything that determines the filter bank kernels
+struct FilterBankKey
+{
+    double sampleRate = 0.0;
+    int firLen = 0;
+    size_t partitionSize = 0;
+    unsigned int numBands = 0;
+    std::array<float, MAX_NUM_BANDS - 1> xOverHz {}; // unused crossovers are left at 0
+
+    bool operator== (const FilterBankKey& other) const = default;
+
+    bool operator< (const FilterBankKey& other) const
+    {
+        return std::tie (sampleRate, firLen, partitionSize, numBands, xOverHz)
+               < std::tie (other.sampleRate,
+                           other.firLen,
+                           other.partitionSize,
+                           other.numBands,
+                           other.xOverHz);
+    }
+};
+
+struct FilterBankKernels
+{
+    juce::AudioBuffer<float> firs; // one channel per band
+    std::shared_ptr<const PartitionedKernel> partitioned;
+};
+
+// eqMode follows doEq: 1 = free field, 2 = diffuse field
+struct EqKey
+{
+    double sampleRate = 0.0;
+    int eqMode = 0;
+    size_t partitionSize = 0;
+
+    bool operator== (const EqKey& other) const = default;
+
+    bool operator< (const EqKey& other) const
+    {
+        return std::tie (sampleRate, eqMode, partitionSize)
+               < std::tie (other.sampleRate, other.eqMode, other.partitionSize);
+    }
+};
+
+struct EqKernels
+{
+    int eqMode = 0;
+    std::shared_ptr<const PartitionedKernel> omni, eight;
+};
+
+/* Handle to kernels that are designed in the background. Polling isReady() is wait free,
+ * so the audio thread can pick up the result as soon as it is there.
+ */
+template <typename Kernels>
+class PendingKernels
+{
+public:
+    bool isReady() const { return ready.load (std::memory_order_acquire); }
+
+    void wait() const { finished.wait (-1); }
+
+    std::shared_ptr<const Kernels> get() const
+    {
+        jassert (isReady());
+        return kernels;
+    }
+
+private:
+    friend class KernelStore;
+
+    void finish (std::shared_ptr<const Kernels> result)
+    {
+        kernels = std::move (result);
+        ready.store (true, std::memory_order_release);
+        finished.signal();
+    }
+
+    std::shared_ptr<const Kernels> kernels;
+    std::atomic<bool> ready { false };
+    juce::WaitableEvent finished { true };
+};
+
+/* Single producer, single consumer queue of fixed capacity. Neither side locks or allocates,
+ * items are moved in and out of preallocated slots.
+ */
+template <typename T, int capacity>
+class WaitFreeQueue
+{
+public:
+    template <typename Item>
+    bool push (Item&& item)
+    {
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        slots[static_cast<size_t> (scope.startIndex1)] = std::forward<Item> (item);
+        return true;
+    }
+
+    bool pop (T& item)
+    {
+        const auto scope = fifo.read (1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        item = std::move (slots[static_cast<size_t> (scope.startIndex1)]);
+        return true;
+    }
+
+    int getFreeSpace() const { return fifo.getFreeSpace(); }
+
+    // neither side may be running
+    void clear()
+    {
+        fifo.reset();
+        std::fill (slots.begin(), slots.end(), T {});
+    }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<T, capacity> slots {};
+};
+
+class KernelRequests;
+
+/* Process wide cache of designed filter kernels, shared by all plugin instances through a
+ * juce::SharedResourcePointer. Kernels are immutable and reference counted: the store only
+ * keeps weak references, so a kernel set lives as long as at least one instance uses it and
+ * only a cache miss triggers a filter design. Designs run in the background, so neither
+ * session loading nor the audio thread ever waits for them.
+ *
+ * The audio thread goes through KernelRequests instead, which the store's request thread
+ * services. That thread also frees the kernels the audio thread let go of.
+ */
+class KernelStore : private juce::Thread
+{
+public:
+    KernelStore() :
+        juce::Thread ("PolarDesigner kernel requests"),
+        designPool (getNumDesignThreads(), 0, juce::Thread::Priority::background)
+    {
+    }
+
+    ~KernelStore() override
+    {
+        stopThread (1000);
+        designPool.removeAllJobs (true, 10000);
+    }
+
+    /* Returns immediately, cached kernels come back ready. Otherwise the design runs on the
+     * store's thread pool, which is shared by all instances and bounds the number of designs
+     * running at the same time. Identical requests in flight share one design.
+     */
+    std::shared_ptr<PendingKernels<FilterBankKernels>> requestFilterBank (const FilterBankKey& key)
+    {
+        return request (key, filterBanks, pendingFilterBanks, [] (const FilterBankKey& k)
+                        { return createFilterBank (k); });
+    }
+
+    std::shared_ptr<PendingKernels<EqKernels>> requestEq (const EqKey& key)
+    {
+        jassert (key.eqMode == 1 || key.eqMode == 2);
+        return request (key, eqs, pendingEqs, [] (const EqKey& k) { return createEq (k); });
+    }
+
+    /* Blocking versions, must not be called from a design job */
+    std::shared_ptr<const FilterBankKernels> getFilterBank (const FilterBankKey& key)
+    {
+        auto pending = requestFilterBank (key);
+        pending->wait();
+        return pending->get();
+    }
+
+    std::shared_ptr<const EqKernels> getEq (const EqKey& key)
+    {
+        auto pending = requestEq (key);
+        pending->wait();
+        return pending->get();
+    }
+
+    int getNumCachedKernelSets()
+    {
+        const juce::ScopedLock sl (lock);
+        removeExpiredEntries();
+        return static_cast<int> (filterBanks.size() + eqs.size());
+    }
+
+    static std::shared_ptr<const FilterBankKernels> createFilterBank (const FilterBankKey& key)
+    {
+        auto kernels = std::make_shared<FilterBankKernels>();
+        kernels->firs = designFilterBank (key);
+        kernels->partitioned = std::make_shared<const PartitionedKernel> (kernels->firs,
+                                                                          key.firLen,
+                                                                          key.partitionSize);
+        return kernels;
+    }
+
+    static std::shared_ptr<const EqKernels> createEq (const EqKey& key)
+    {
+        const auto irs = designEq (key.sampleRate, key.eqMode);
+
+        juce::AudioBuffer<float> omni (1, irs.getNumSamples());
+        juce::AudioBuffer<float> eight (1, irs.getNumSamples());
+        omni.copyFrom (0, 0, irs, 0, 0, irs.getNumSamples());
+        eight.copyFrom (0, 0, irs, 1, 0, irs.getNumSamples());
+
+        auto kernels = std::make_shared<EqKernels>();
+        kernels->eqMode = key.eqMode;
+        kernels->omni = std::make_shared<const PartitionedKernel> (omni,
+                                                                   irs.getNumSamples(),
+                                                                   key.partitionSize);
+        kernels->eight = std::make_shared<const PartitionedKernel> (eight,
+                                                                    irs.getNumSamples(),
+                                                                    key.partitionSize);
+        return kernels;
+    }
+
+    //==============================================================================
+    /* Windowed sinc crossover design. Band 0 is a lowpass, the last band a highpass and
+     * everything in between a bandpass modulated from a lowpass prototype.
+     */
+    static juce::AudioBuffer<float> designFilterBank (const FilterBankKey& key)
+    {
+        using namespace juce;
+        using namespace dsp;
+
+        const auto firLen = key.firLen;
+        const auto nBands = key.numBands;
+        const auto sampleRate = key.sampleRate;
+        const auto window = WindowingFunction<float>::WindowingMethod::hamming;
+
+        AudioBuffer<float> firs (static_cast<int> (nBands), firLen);
+        firs.clear();
+
+        if (nBands < 2)
+            return firs;
+
+        // Lowest band: lowpass
+        {
+            auto lowpass = FilterDesign<float>::designFIRLowpassWindowMethod (
+                key.xOverHz[0],
+                sampleRate,
+                static_cast<size_t> (firLen - 1),
+                window);
+            firs.copyFrom (0, 0, lowpass->getRawCoefficients(), firLen - 1);
+        }
+
+        // Bandpass filters
+        for (unsigned int i = 1; i < nBands - 1; ++i)
+        {
+            const float halfBandwidth = (key.xOverHz[i] - key.xOverHz[i - 1]) / 2;
+            auto lp2bp = FilterDesign<float>::designFIRLowpassWindowMethod (
+                halfBandwidth,
+                sampleRate,
+                static_cast<size_t> (firLen - 1),
+                window);
+
+            const auto* lp2bpCoeffs = lp2bp->getRawCoefficients();
+            auto* fir = firs.getWritePointer (static_cast<int> (i));
+            const auto fCenter = halfBandwidth + key.xOverHz[i - 1];
+
+            for (int j = 0; j < firLen; j++)
+            {
+                fir[j] = 2 * lp2bpCoeffs[j]
+                         * std::cos (MathConstants<float>::twoPi * fCenter
+                                     / static_cast<float> (sampleRate)
+                                     * static_cast<float> (j - (firLen - 1.0) / 2));
+            }
+        }
+
+        // Highest band: highpass
+        {
+            const auto hpBandwidth =
+                static_cast<float> (sampleRate / 2 - key.xOverHz[nBands - 2]);
+            auto lp2hp = FilterDesign<float>::designFIRLowpassWindowMethod (
+                hpBandwidth,
+                sampleRate,
+                static_cast<size_t> (firLen - 1),
+                window);
+
+            const auto* lp2hpCoeffs = lp2hp->getRawCoefficients();
+            auto* fir = firs.getWritePointer (static_cast<int> (nBands) - 1);
+
+            for (int i = 0; i < firLen; ++i)
+            {
+                fir[i] = lp2hpCoeffs[i]
+                         * std::cos (MathConstants<float>::pi
+                                     * (static_cast<float> (i)
+                                        - (static_cast<float> (firLen) - 1.0f) / 2));
+            }
+        }
+
+        return firs;
+    }
+
+    /* Omni (channel 0) and eight (channel 1) EQ impulse responses, resampled from
+     * EQ_SAMPLE_RATE if needed.
+     */
+    static juce::AudioBuffer<float> designEq (double sampleRate, int eqMode)
+    {
+        using namespace juce;
+
+        jassert (DF_EQ_LEN == FF_EQ_LEN);
+
+        const auto* omniCoeffs = eqMode == 2 ? DFEQ_COEFFS_OMNI : FFEQ_COEFFS_OMNI;
+        const auto* eightCoeffs = eqMode == 2 ? DFEQ_COEFFS_EIGHT : FFEQ_COEFFS_EIGHT;
+
+        AudioBuffer<float> irs (2, getEqLength (sampleRate));
+
+        // we don't need to resample
+        if (approximatelyEqual (sampleRate, static_cast<double> (EQ_SAMPLE_RATE)))
+        {
+            irs.copyFrom (0, 0, omniCoeffs, DF_EQ_LEN);
+            irs.copyFrom (1, 0, eightCoeffs, DF_EQ_LEN);
+            return irs;
+        }
+
+        // we do need to resample
+        WindowedSincInterpolator resampler;
+        const auto ratio = EQ_SAMPLE_RATE / sampleRate;
+
+        resampler.process (ratio,
+                           omniCoeffs,
+                           irs.getWritePointer (0),
+                           irs.getNumSamples(),
+                           DF_EQ_LEN,
+                           0);
+        resampler.reset(); // resampler is stateful, we need to reset it
+
+        resampler.process (ratio,
+                           eightCoeffs,
+                           irs.getWritePointer (1),
+                           irs.getNumSamples(),
+                           DF_EQ_LEN,
+                           0);
+
+        // resampling requires a power correction
+        irs.applyGain (static_cast<float> (ratio));
+
+        return irs;
+    }
+
+    static int getEqLength (double sampleRate)
+    {
+        if (juce::approximatelyEqual (sampleRate, static_cast<double> (EQ_SAMPLE_RATE)))
+            return DF_EQ_LEN;
+
+        juce::WindowedSincInterpolator resampler;
+        return static_cast<int> (std::ceil ((DF_EQ_LEN + 2 * resampler.getBaseLatency())
+                                            * sampleRate / EQ_SAMPLE_RATE));
+    }
+
+    static int getEqLatency (double sampleRate)
+    {
+        if (juce::approximatelyEqual (sampleRate, static_cast<double> (EQ_SAMPLE_RATE)))
+            return 0;
+
+        juce::WindowedSincInterpolator resampler;
+        return static_cast<int> (
+            std::ceil (resampler.getBaseLatency() * sampleRate / EQ_SAMPLE_RATE));
+    }
+
+private:
+    friend class KernelRequests;
+
+    // the queues are polled, so the audio thread never has to wake up another thread
+    static constexpr int requestIntervalMs = 10;
+
+    void addClient (KernelRequests* client)
+    {
+        const juce::ScopedLock sl (clientsLock);
+        clients.add (client);
+        startThread (juce::Thread::Priority::background);
+    }
+
+    void removeClient (KernelRequests* client)
+    {
+        const juce::ScopedLock sl (clientsLock);
+        clients.removeFirstMatchingValue (client);
+    }
+
+    void run() override;
+
+    // request thread only
+    void retain (std::shared_ptr<const void> object)
+    {
+        for (const auto& retained : retainedObjects)
+            if (retained.get() == object.get())
+                return;
+
+        retainedObjects.push_back (std::move (object));
+    }
+
+    // nothing else can get hold of an object once its last user let go of it
+    void releaseUnusedObjects()
+    {
+        std::erase_if (retainedObjects,
+                       [] (const auto& object) { return object.use_count() == 1; });
+    }
+
+    template <typename Key, typename Kernels, typename CreateFn>
+    std::shared_ptr<PendingKernels<Kernels>>
+        request (const Key& key,
+                 std::map<Key, std::weak_ptr<const Kernels>>& cache,
+                 std::map<Key, std::weak_ptr<PendingKernels<Kernels>>>& inFlight,
+                 CreateFn create)
+    {
+        const juce::ScopedLock sl (lock);
+
+        auto pending = std::make_shared<PendingKernels<Kernels>>();
+
+        if (auto existing = cache[key].lock())
+        {
+            pending->finish (std::move (existing));
+            return pending;
+        }
+
+        if (auto running = inFlight[key].lock())
+            return running;
+
+        inFlight[key] = pending;
+        removeExpiredEntries();
+
+        designPool.addJob (
+            [this, key, weakPending = std::weak_ptr (pending), create, &cache, &inFlight]
+            {
+                auto kernels = create (key);
+
+                {
+                    const juce::ScopedLock jobLock (lock);
+                    cache[key] = kernels;
+                    inFlight.erase (key);
+                }
+
+                // nobody is waiting anymore if all requesters are gone
+                if (auto p = weakPending.lock())
+                    p->finish (std::move (kernels));
+            });
+
+        return pending;
+    }
+
+    static int getNumDesignThreads()
+    {
+        return juce::jlimit (1, maxDesignThreads, juce::SystemStats::getNumCpus() - 1);
+    }
+
+    void removeExpiredEntries()
+    {
+        for (auto it = filterBanks.begin(); it != filterBanks.end();)
+            it = it->second.expired() ? filterBanks.erase (it) : std::next (it);
+
+        for (auto it = eqs.begin(); it != eqs.end();)
+            it = it->second.expired() ? eqs.erase (it) : std::next (it);
+
+        for (auto it = pendingFilterBanks.begin(); it != pendingFilterBanks.end();)
+            it = it->second.expired() ? pendingFilterBanks.erase (it) : std::next (it);
+
+        for (auto it = pendingEqs.begin(); it != pendingEqs.end();)
+            it = it->second.expired() ? pendingEqs.erase (it) : std::next (it);
+    }
+
+    static constexpr int maxDesignThreads = 2;
+
+    juce::CriticalSection clientsLock;
+    juce::Array<KernelRequests*> clients;
+    std::vector<std::shared_ptr<const void>> retainedObjects;
+
+    juce::CriticalSection lock;
+    std::map<FilterBankKey, std::weak_ptr<const FilterBankKernels>> filterBanks;
+    std::map<EqKey, std::weak_ptr<const EqKernels>> eqs;
+    std::map<FilterBankKey, std::weak_ptr<PendingKernels<FilterBankKernels>>> pendingFilterBanks;
+    std::map<EqKey, std::weak_ptr<PendingKernels<EqKernels>>> pendingEqs;
+
+    // last member, so it is destroyed (and its jobs are finished) before the maps
+    juce::ThreadPool designPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KernelStore)
+};
+
+/* The kernel requests of one engine. The audio thread must neither lock, allocate nor free
+ * memory, so it only queues the keys. The store's request thread turns them into requests and
+ * swaps the pending kernels in. Everything the audio thread picks up is queued back to the store
+ * as well, which holds on to it until nobody else uses it and frees it on its own thread.
+ */
+class KernelRequests
+{
+public:
+    explicit KernelRequests (KernelStore& storeToUse) : store (storeToUse)
+    {
+        store.addClient (this);
+    }
+
+    ~KernelRequests() { store.removeClient (this); }
+
+    // audio thread: false while the queue is full, the request has to be repeated then
+    bool queue (const FilterBankKey& key) { return filterBankKeys.push (key); }
+    bool queue (const EqKey& key) { return eqKeys.push (key); }
+
+    // any other thread, or an audio thread that may wait
+    void request (const FilterBankKey& key)
+    {
+        swapPending (pendingFilterBank, store.requestFilterBank (key));
+    }
+
+    void request (const EqKey& key) { swapPending (pendingEq, store.requestEq (key)); }
+
+    // drops queued and pending requests, while the audio thread is not running
+    void clear()
+    {
+        const juce::ScopedLock sl (store.clientsLock);
+        filterBankKeys.clear();
+        eqKeys.clear();
+        swapPending (pendingFilterBank, nullptr);
+        swapPending (pendingEq, nullptr);
+    }
+
+    /* Audio thread: the kernels of the latest request once they are ready, nullptr before.
+     * Offline renders wait for them instead.
+     */
+    std::shared_ptr<const FilterBankKernels> takeFilterBank (bool waitUntilReady)
+    {
+        return take (pendingFilterBank, waitUntilReady);
+    }
+
+    std::shared_ptr<const EqKernels> takeEq (bool waitUntilReady)
+    {
+        return take (pendingEq, waitUntilReady);
+    }
+
+private:
+    friend class KernelStore;
+
+    // request thread: only the latest key of each kind matters
+    void service()
+    {
+        std::optional<FilterBankKey> filterBankKey;
+        for (FilterBankKey key; filterBankKeys.pop (key);)
+            filterBankKey = key;
+        if (filterBankKey.has_value())
+            request (*filterBankKey);
+
+        std::optional<EqKey> eqKey;
+        for (EqKey key; eqKeys.pop (key);)
+            eqKey = key;
+        if (eqKey.has_value())
+            request (*eqKey);
+
+        for (std::shared_ptr<const void> object; retained.pop (object);)
+            store.retain (std::move (object));
+    }
+
+    // the replaced request is dropped outside the lock
+    template <typename Kernels>
+    void swapPending (std::shared_ptr<PendingKernels<Kernels>>& pending,
+                      std::type_identity_t<std::shared_ptr<PendingKernels<Kernels>>> replacement)
+    {
+        {
+            const juce::SpinLock::ScopedLockType sl (pendingLock);
+            std::swap (pending, replacement);
+        }
+    }
+
+    template <typename Kernels>
+    std::shared_ptr<const Kernels> take (std::shared_ptr<PendingKernels<Kernels>>& pending,
+                                         bool waitUntilReady)
+    {
+        // the lock is only held to swap in new requests, so it's fine to skip a block
+        const juce::SpinLock::ScopedTryLockType sl (pendingLock);
+        if (! sl.isLocked() || pending == nullptr)
+            return nullptr;
+
+        if (waitUntilReady)
+            pending->wait();
+
+        // the kernels, their partitioned parts and the request itself
+        if (! pending->isReady() || retained.getFreeSpace() < maxRetainedPerTake)
+            return nullptr;
+
+        auto kernels = pending->get();
+        retainParts (*kernels);
+        retained.push (std::shared_ptr<const void> (kernels));
+        retained.push (std::move (pending));
+        return kernels;
+    }
+
+    void retainParts (const FilterBankKernels& kernels) { retained.push (kernels.partitioned); }
+
+    void retainParts (const EqKernels& kernels)
+    {
+        retained.push (kernels.omni);
+        retained.push (kernels.eight);
+    }
+
+    static constexpr int maxRetainedPerTake = 4;
+
+    KernelStore& store;
+
+    WaitFreeQueue<FilterBankKey, 8> filterBankKeys;
+    WaitFreeQueue<EqKey, 8> eqKeys;
+    WaitFreeQueue<std::shared_ptr<const void>, 32> retained;
+
+    juce::SpinLock pendingLock;
+    std::shared_ptr<PendingKernels<FilterBankKernels>> pendingFilterBank;
+    std::shared_ptr<PendingKernels<EqKernels>> pendingEq;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KernelRequests)
+};
+
+inline void KernelStore::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl (clientsLock);
+            for (auto* client : clients)
+                client->service();
+        }
+
+        releaseUnusedObjects();
+        wait (requestIntervalMs);
+    }
+}
@@ -0,0 +1,231 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "ComplexMultiply.hpp"
+#include "Constants.hpp"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+/* Single pass kernels for the time domain stages around the convolutions. Each one reads its
+ * inputs and writes its outputs exactly once, the scalar variants are written so compilers
+ * can vectorise them for the baseline instruction set, wider variants are picked at runtime.
+ */
+
+/* The ramps of all bands of one mix, structure of arrays, only the audible bands are listed.
+ * Sample i of band b contributes
+ *   omni[b][i] * (omniStart[b] + i * omniStep[b])
+ *   + eight[b][i] * (eightStart[b] + i * eightStep[b])
+ */
+struct BandMix
+{
+    const float* omni[MAX_NUM_BANDS];
+    const float* eight[MAX_NUM_BANDS];
+    float omniStart[MAX_NUM_BANDS], omniStep[MAX_NUM_BANDS];
+    float eightStart[MAX_NUM_BANDS], eightStep[MAX_NUM_BANDS];
+    unsigned int numBands = 0;
+};
+
+// omni = front + back, eight = front - back
+using MatrixFn = void (*) (const float* front,
+                           const float* back,
+                           float* omni,
+                           float* eight,
+                           size_t numSamples);
+
+// output = sum of all bands, output may alias any of the band inputs
+using RampedMixFn = void (*) (const BandMix& mix, float* output, size_t numSamples);
+
+// one variant per band count, so the band loops are unrolled at compile time
+using RampedMixTable = std::array<RampedMixFn, MAX_NUM_BANDS + 1>;
+
+static inline void matrixScalar (const float* front,
+                                 const float* back,
+                                 float* omni,
+                                 float* eight,
+                                 size_t numSamples)
+{
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto f = front[i], b = back[i];
+        omni[i] = f + b;
+        eight[i] = f - b;
+    }
+}
+
+template <unsigned int NumBands>
+static inline void rampedMixSamples (const BandMix& mix, float* output, size_t first, size_t last)
+{
+    jassert (mix.numBands == NumBands);
+
+    if constexpr (NumBands == 0)
+    {
+        std::fill (output + first, output + last, 0.0f);
+    }
+    else
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto t = static_cast<float> (i);
+            float sum = 0.0f;
+            for (unsigned int b = 0; b < NumBands; ++b)
+                sum += mix.omni[b][i] * (mix.omniStart[b] + t * mix.omniStep[b])
+                       + mix.eight[b][i] * (mix.eightStart[b] + t * mix.eightStep[b]);
+            output[i] = sum;
+        }
+    }
+}
+
+template <unsigned int NumBands>
+static inline void rampedMixScalar (const BandMix& mix, float* output, size_t numSamples)
+{
+    rampedMixSamples<NumBands> (mix, output, 0, numSamples);
+}
+
+/* Matrixing fused with the first order proximity filter { b0, b1, a1 } on either the omni or
+ * the eight signal. The recursion keeps this scalar, it still saves the extra pass.
+ */
+template <bool FilterEight>
+static inline void matrixWithFirstOrderFilter (const float* front,
+                                               const float* back,
+                                               float* omni,
+                                               float* eight,
+                                               size_t numSamples,
+                                               const float* coefficients,
+                                               float& state)
+{
+    const auto b0 = coefficients[0], b1 = coefficients[1], a1 = coefficients[2];
+    auto s = state;
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto f = front[i], b = back[i];
+        auto o = f + b, e = f - b;
+
+        auto& x = FilterEight ? e : o;
+        const auto y = b0 * x + s;
+        s = b1 * x - a1 * y;
+        x = y;
+
+        omni[i] = o;
+        eight[i] = e;
+    }
+
+    // flush the state to zero like juce::dsp::IIR::Filter does, to avoid denormals
+    state = (s < -1.0e-8f || s > 1.0e-8f) ? s : 0.0f;
+}
+
+#if JUCE_INTEL
+PD_TARGET_AVX2 static inline void matrixAVX2 (const float* front,
+                                              const float* back,
+                                              float* omni,
+                                              float* eight,
+                                              size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const auto f = _mm256_loadu_ps (front + i);
+        const auto b = _mm256_loadu_ps (back + i);
+        _mm256_storeu_ps (omni + i, _mm256_add_ps (f, b));
+        _mm256_storeu_ps (eight + i, _mm256_sub_ps (f, b));
+    }
+
+    matrixScalar (front + i, back + i, omni + i, eight + i, numSamples - i);
+}
+
+template <unsigned int NumBands>
+PD_TARGET_AVX2 static inline void rampedMixAVX2 (const BandMix& mix,
+                                                 float* output,
+                                                 size_t numSamples)
+{
+    static_assert (NumBands > 0);
+    jassert (mix.numBands == NumBands);
+
+    const auto lanes = _mm256_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const auto t = _mm256_add_ps (_mm256_set1_ps (static_cast<float> (i)), lanes);
+        auto sum = _mm256_setzero_ps();
+
+        for (unsigned int b = 0; b < NumBands; ++b)
+        {
+            const auto omniGain = _mm256_fmadd_ps (
+                t, _mm256_set1_ps (mix.omniStep[b]), _mm256_set1_ps (mix.omniStart[b]));
+            const auto eightGain = _mm256_fmadd_ps (
+                t, _mm256_set1_ps (mix.eightStep[b]), _mm256_set1_ps (mix.eightStart[b]));
+
+            sum = _mm256_fmadd_ps (_mm256_loadu_ps (mix.omni[b] + i), omniGain, sum);
+            sum = _mm256_fmadd_ps (_mm256_loadu_ps (mix.eight[b] + i), eightGain, sum);
+        }
+
+        _mm256_storeu_ps (output + i, sum);
+    }
+
+    // remaining samples, continuing the ramps
+    rampedMixSamples<NumBands> (mix, output, i, numSamples);
+}
+
+// nothing to vectorise without any bands
+template <size_t... NumBands>
+constexpr RampedMixTable makeRampedMixAVX2Table (std::index_sequence<NumBands...>)
+{
+    return { { &rampedMixScalar<0>, &rampedMixAVX2<NumBands + 1>... } };
+}
+#endif
+
+template <size_t... NumBands>
+constexpr RampedMixTable makeRampedMixScalarTable (std::index_sequence<NumBands...>)
+{
+    return { { &rampedMixScalar<NumBands>... } };
+}
+
+struct MixKernels
+{
+    MatrixFn matrix;
+    RampedMixTable rampedMix; // indexed by the number of audible bands
+    const char* name;
+};
+
+/* Resolved once per process */
+inline const MixKernels& getMixKernels()
+{
+    static const MixKernels selected = []() -> MixKernels
+    {
+#if JUCE_INTEL
+        if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3())
+            return { matrixAVX2,
+                     makeRampedMixAVX2Table (std::make_index_sequence<MAX_NUM_BANDS>()),
+                     "AVX2" };
+#endif
+        return { matrixScalar,
+                 makeRampedMixScalarTable (std::make_index_sequence<MAX_NUM_BANDS + 1>()),
+                 "Scalar" };
+    }();
+
+    return selected;
+}
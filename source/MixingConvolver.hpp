@@ -0,0 +1,631 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "Constants.hpp"
+#include "PartitionedConvolver.hpp"
+
+#include <array>
+
+/* Filter bank and pattern mix in one: convolves the omni and eight signals with weighted sums
+ * of the band kernels and adds up the results.
+ *
+ * The mix is linear, so instead of filtering every band and mixing the band signals, the band
+ * spectra are mixed once per weight change. Processing then costs one partitioned convolution
+ * per input and a single inverse transform, however many bands there are. Every weight change
+ * mixes bands x segments x bins again though, so the saving only holds while the weights stay
+ * put. Under constant automation that pass runs once per host block and grows with the number
+ * of bands like the filter bank did. Muted and non-soloed bands carry no weight and are
+ * skipped while mixing. Weight ramps are a
+ * crossfade between the convolutions with the start and end weights, which gives the same
+ * result as ramping the gain of every band.
+ *
+ * A second voice mixes another set of weights from the same input spectra, at the cost of the
+ * spectral products and one inverse transform.
+ */
+class MixingConvolver
+{
+public:
+    // per band gains of the omni and the eight signal
+    struct Weights
+    {
+        std::array<float, MAX_NUM_BANDS> omni {}, eight {};
+
+        bool operator== (const Weights& other) const = default;
+    };
+
+    static constexpr int maxVoices = 2;
+
+    MixingConvolver() = default;
+
+    /* Allocates all state from the arena of the owner and drops the band kernels, which were
+     * partitioned for the previous size. Band kernels set later on must not exceed maxIrLength.
+     */
+    void prepare (size_t partitionSize,
+                  int maxIrLength,
+                  double sampleRate,
+                  ScratchArena& arena,
+                  int numVoicesToUse = 1)
+    {
+        jassert (juce::isPowerOfTwo (partitionSize));
+        jassert (numVoicesToUse >= 1 && numVoicesToUse <= maxVoices);
+
+        blockSize = partitionSize;
+        fftSize = 2 * partitionSize;
+        numBins = partitionSize + 1;
+        maxSegments = getNumSegments (partitionSize, maxIrLength);
+        numSlots = maxSegments + 1;
+
+        fft = FftBackend::createFastest (fftSize);
+        multiplyAccumulate = getComplexMultiplyAccumulate().function;
+
+        // in the order they are used while processing a partition
+        for (auto* input : { &omniInput, &eightInput })
+        {
+            input->buffer = arena.take (fftSize);
+            input->delayLine = arena.take (numSlots * 2 * numBins);
+        }
+        accumulator = arena.take (2 * numBins);
+
+        numVoices = juce::jlimit (1, maxVoices, numVoicesToUse);
+        for (int v = 0; v < numVoices; ++v)
+        {
+            for (auto& lane : voices[static_cast<size_t> (v)].lanes)
+            {
+                lane.allocate (arena, maxSegments, numBins, blockSize);
+                lane.bands.reset();
+            }
+        }
+
+        bands.reset();
+        bandFadeLength = std::max (static_cast<int> (blockSize),
+                                   juce::roundToInt (sampleRate * bandCrossfadeSeconds));
+
+        reset();
+    }
+
+    // bytes prepare() takes from an arena
+    static size_t getScratchSize (size_t partitionSize, int maxIrLength, int numVoices = 1)
+    {
+        const auto bins = partitionSize + 1;
+        const auto segments = getNumSegments (partitionSize, maxIrLength);
+
+        return 2 * ScratchArena::getSliceSize (2 * partitionSize)
+               + 2 * ScratchArena::getSliceSize ((segments + 1) * 2 * bins)
+               + ScratchArena::getSliceSize (2 * bins)
+               + static_cast<size_t> (2 * numVoices)
+                     * Lane::getScratchSize (segments, bins, partitionSize);
+    }
+
+    // clears the convolution history, the band kernels and weights are kept
+    void reset()
+    {
+        for (auto* input : { &omniInput, &eightInput })
+        {
+            std::fill (input->buffer.begin(), input->buffer.end(), 0.0f);
+            std::fill (input->delayLine.begin(), input->delayLine.end(), 0.0f);
+        }
+
+        inputPos = 0;
+        head = 0;
+
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto& voice = voices[static_cast<size_t> (v)];
+            for (auto& lane : voice.lanes)
+                lane.clearState();
+
+            voice.fadePosition = 0;
+            voice.fadeLength = 0;
+            voice.fading = false;
+            voice.fadingBands = false;
+            voice.catchingUp = false;
+            voice.rampQueued = false;
+            voice.bandsQueued = false;
+            voice.rendering = false;
+        }
+    }
+
+    int getNumVoices() const { return numVoices; }
+
+    /* The band kernels, one per band. A new set is crossfaded in with the current weights, after
+     * a weight ramp that is still running. Audio thread only.
+     */
+    void setBands (std::shared_ptr<const PartitionedKernel> newBands)
+    {
+        jassert (newBands == nullptr
+                 || (newBands->blockSize == blockSize && newBands->numSegments <= maxSegments
+                     && newBands->numKernels <= static_cast<int> (MAX_NUM_BANDS)));
+
+        if (newBands == bands)
+            return;
+
+        bands = std::move (newBands);
+
+        if (bands == nullptr)
+            return;
+
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto& voice = voices[static_cast<size_t> (v)];
+
+            // both lanes are busy with the ramp
+            if (voice.rendering && voice.fading && ! voice.fadingBands)
+                voice.bandsQueued = true;
+            else
+                fadeToBands (voice);
+        }
+    }
+
+    /* The output of the voice fades from the start to the end weights over the next
+     * rampLength samples. Unchanged weights cost nothing, changed ones cost a pass over the band
+     * spectra. While new band kernels fade in, the ramp waits for the fade to finish and then
+     * continues from the weights reached so far. Audio thread only.
+     */
+    void setWeights (const Weights& start, const Weights& end, int rampLength, int voiceIndex = 0)
+    {
+        jassert (rampLength > 0);
+        jassert (voiceIndex >= 0 && voiceIndex < numVoices);
+
+        if (bands == nullptr)
+            return;
+
+        auto& voice = voices[static_cast<size_t> (voiceIndex)];
+
+        // only the latest target of the ramps that wait is kept
+        if (voice.rendering && hasQueuedFades (voice))
+        {
+            voice.queuedWeights = end;
+            voice.queuedRampLength = rampLength;
+            voice.rampQueued = true;
+            return;
+        }
+
+        // usually the lane that rendered the end of the last ramp continues
+        voice.fading = false;
+        voice.rampQueued = false;
+        if (! voice.current().matches (bands, start))
+        {
+            voice.currentLane = 1 - voice.currentLane;
+            useLane (voice, voice.current(), start);
+        }
+
+        if (start == end)
+            return;
+
+        voice.currentLane = 1 - voice.currentLane;
+        useLane (voice, voice.current(), end);
+        startFade (voice, rampLength);
+    }
+
+    /* Adds up the convolutions of omni and eight with their mixed band kernels into output,
+     * which may alias neither input. Without output, the inputs are only fed into the
+     * history, so rendering can start later on without a transient.
+     */
+    void process (const float* omni, const float* eight, float* output, size_t numSamples)
+    {
+        process (omni, eight, { output, nullptr }, numSamples);
+    }
+
+    // one output per voice, voices without an output are not rendered
+    void process (const float* omni,
+                  const float* eight,
+                  const std::array<float*, maxVoices>& outputs,
+                  size_t numSamples)
+    {
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto& voice = voices[static_cast<size_t> (v)];
+            const bool render =
+                outputs[static_cast<size_t> (v)] != nullptr && voice.current().bands != nullptr;
+            if (render && ! voice.rendering)
+                rebuildStateFromHistory (voice);
+            voice.rendering = render;
+        }
+
+        size_t done = 0;
+        while (done < numSamples)
+        {
+            startQueuedFades();
+
+            if (inputPos == 0)
+                beginPartition();
+
+            const auto n = std::min (numSamples - done, blockSize - inputPos);
+            feedInput (omniInput, omni + done, n);
+            feedInput (eightInput, eight + done, n);
+
+            for (int v = 0; v < numVoices; ++v)
+            {
+                auto& voice = voices[static_cast<size_t> (v)];
+                if (! voice.rendering)
+                    continue;
+
+                auto* output = outputs[static_cast<size_t> (v)] + done;
+                processLane (voice, voice.current(), output, n, false);
+
+                if (voice.fading)
+                {
+                    processLane (voice, voice.previous(), output, n, true);
+
+                    voice.fadePosition += static_cast<int> (n);
+                    if (voice.fadePosition >= voice.fadeLength)
+                        voice.fading = false;
+                }
+            }
+
+            inputPos += n;
+            done += n;
+
+            if (inputPos == blockSize)
+                endPartition();
+        }
+    }
+
+private:
+    struct Input
+    {
+        std::span<float> buffer, delayLine;
+    };
+
+    struct Lane
+    {
+        static size_t getScratchSize (size_t segments, size_t bins, size_t block)
+        {
+            return 2 * ScratchArena::getSliceSize (segments * 2 * bins)
+                   + ScratchArena::getSliceSize (2 * bins)
+                   + ScratchArena::getSliceSize (2 * block)
+                   + ScratchArena::getSliceSize (block);
+        }
+
+        void allocate (ScratchArena& arena, size_t segments, size_t bins, size_t block)
+        {
+            numBins = bins;
+            omniKernel = arena.take (segments * 2 * bins);
+            eightKernel = arena.take (segments * 2 * bins);
+            tail = arena.take (2 * bins);
+            result = arena.take (2 * block);
+            overlap = arena.take (block);
+        }
+
+        void clearState()
+        {
+            std::fill (tail.begin(), tail.end(), 0.0f);
+            std::fill (result.begin(), result.end(), 0.0f);
+            std::fill (overlap.begin(), overlap.end(), 0.0f);
+        }
+
+        bool matches (const std::shared_ptr<const PartitionedKernel>& b, const Weights& w) const
+        {
+            return bands == b && weights == w;
+        }
+
+        const float* omniSegment (size_t s) const { return omniKernel.data() + s * 2 * numBins; }
+        const float* eightSegment (size_t s) const
+        {
+            return eightKernel.data() + s * 2 * numBins;
+        }
+
+        std::shared_ptr<const PartitionedKernel> bands;
+        Weights weights;
+        size_t numSegments = 0, numBins = 0;
+        std::span<float> omniKernel, eightKernel, tail, result, overlap;
+    };
+
+    // one pattern mix, its two lanes crossfade between weights or band kernels
+    struct Voice
+    {
+        Lane& current() { return lanes[currentLane]; }
+        Lane& previous() { return lanes[1 - currentLane]; }
+
+        Lane lanes[2];
+        int currentLane = 0;
+        int fadeLength = 0, fadePosition = 0;
+        bool fading = false, fadingBands = false, catchingUp = false, rendering = false;
+
+        // fades requested while both lanes were busy, the band kernels go first
+        Weights queuedWeights;
+        int queuedRampLength = 0;
+        bool rampQueued = false, bandsQueued = false;
+    };
+
+    static size_t getNumSegments (size_t partitionSize, int irLength)
+    {
+        const auto size = static_cast<int> (partitionSize);
+        return static_cast<size_t> (std::max (1, (irLength + size - 1) / size));
+    }
+
+    const float* historySpectrum (const Input& input, size_t partitionsAgo) const
+    {
+        jassert (partitionsAgo < numSlots);
+        const auto idx = (head + numSlots - partitionsAgo) % numSlots;
+        return input.delayLine.data() + idx * 2 * numBins;
+    }
+
+    void feedInput (Input& input, const float* samples, size_t n)
+    {
+        std::copy_n (samples, n, input.buffer.data() + inputPos);
+
+        std::copy_n (input.buffer.data(), fftSize, fft->getTimeData());
+        fft->forward();
+        std::copy_n (fft->getFrequencyData(),
+                     2 * numBins,
+                     input.delayLine.data() + head * 2 * numBins);
+    }
+
+    void inverseTransform (const float* spectrum, float* result)
+    {
+        std::copy_n (spectrum, 2 * numBins, fft->getFrequencyData());
+        fft->inverse();
+        std::copy_n (fft->getTimeData(), fftSize, result);
+    }
+
+    static void startFade (Voice& voice, int length)
+    {
+        voice.fading = true;
+        voice.fadingBands = false;
+        voice.catchingUp = false;
+        voice.fadePosition = 0;
+        voice.fadeLength = length;
+    }
+
+    // a band kernel fade or a ramp catching up with it is running or waiting to start
+    static bool hasQueuedFades (const Voice& voice)
+    {
+        return voice.rampQueued || voice.bandsQueued
+               || (voice.fading && (voice.fadingBands || voice.catchingUp));
+    }
+
+    void fadeToBands (Voice& voice)
+    {
+        voice.bandsQueued = false;
+
+        // nothing has been rendered with the old kernels, so there is nothing to fade from
+        const auto weights = voice.current().weights;
+        if (! voice.rendering || voice.current().bands == nullptr)
+        {
+            voice.fading = false;
+            rebuildLane (voice, voice.current(), weights);
+            return;
+        }
+
+        voice.currentLane = 1 - voice.currentLane;
+        rebuildLane (voice, voice.current(), weights);
+        startFade (voice, bandFadeLength);
+        voice.fadingBands = true;
+    }
+
+    /* Runs before a chunk is fed, where the lane state can be rebuilt like between two process()
+     * calls. A queued ramp starts from the weights the finished fade ended on.
+     */
+    void startQueuedFades()
+    {
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto& voice = voices[static_cast<size_t> (v)];
+            if (voice.fading || ! voice.rendering || bands == nullptr)
+                continue;
+
+            if (voice.bandsQueued)
+            {
+                if (voice.current().bands != bands)
+                    fadeToBands (voice);
+                voice.bandsQueued = false;
+                continue;
+            }
+
+            if (! voice.rampQueued)
+                continue;
+
+            voice.rampQueued = false;
+            if (voice.current().matches (bands, voice.queuedWeights))
+                continue;
+
+            voice.currentLane = 1 - voice.currentLane;
+            useLane (voice, voice.current(), voice.queuedWeights);
+            startFade (voice, voice.queuedRampLength);
+            voice.catchingUp = true;
+        }
+    }
+
+    // lanes that have not been rendered lately only need their state brought up to date
+    void useLane (const Voice& voice, Lane& lane, const Weights& weights)
+    {
+        if (! lane.matches (bands, weights))
+            rebuildLane (voice, lane, weights);
+        else if (voice.rendering)
+            rebuildLaneState (lane);
+    }
+
+    /* Mixes the band spectra with the given weights, then brings the convolution state of the
+     * lane up to date with the input history.
+     */
+    void rebuildLane (const Voice& voice, Lane& lane, const Weights& weights)
+    {
+        using namespace juce;
+
+        lane.bands = bands;
+        lane.weights = weights;
+        lane.numSegments = bands->numSegments;
+
+        const auto size = static_cast<int> (2 * numBins);
+        std::fill (lane.omniKernel.begin(), lane.omniKernel.end(), 0.0f);
+        std::fill (lane.eightKernel.begin(), lane.eightKernel.end(), 0.0f);
+
+        // real weights scale real and imaginary parts alike
+        for (int b = 0; b < bands->numKernels; ++b)
+        {
+            const auto omniWeight = weights.omni[static_cast<size_t> (b)];
+            const auto eightWeight = weights.eight[static_cast<size_t> (b)];
+
+            for (size_t s = 0; s < lane.numSegments; ++s)
+            {
+                const auto* segment = bands->getSegment (b, s);
+                auto* omni = lane.omniKernel.data() + s * 2 * numBins;
+                auto* eight = lane.eightKernel.data() + s * 2 * numBins;
+
+                if (! exactlyEqual (omniWeight, 0.0f))
+                    FloatVectorOperations::addWithMultiply (omni, segment, omniWeight, size);
+                if (! exactlyEqual (eightWeight, 0.0f))
+                    FloatVectorOperations::addWithMultiply (eight, segment, eightWeight, size);
+            }
+        }
+
+        if (voice.rendering)
+            rebuildLaneState (lane);
+    }
+
+    /* Reconstructs the overlap of the last completed partition and, within a partition, the
+     * tail, as if the lane's kernels had been active all along. The delay lines hold one slot
+     * more than the longest kernel needs for this.
+     */
+    void rebuildLaneState (Lane& lane)
+    {
+        std::fill (accumulator.begin(), accumulator.end(), 0.0f);
+        for (size_t s = 0; s < lane.numSegments; ++s)
+        {
+            multiplyAccumulate (accumulator.data(),
+                                historySpectrum (omniInput, s + 1),
+                                lane.omniSegment (s),
+                                numBins);
+            multiplyAccumulate (accumulator.data(),
+                                historySpectrum (eightInput, s + 1),
+                                lane.eightSegment (s),
+                                numBins);
+        }
+
+        inverseTransform (accumulator.data(), lane.result.data());
+        std::copy_n (lane.result.data() + blockSize, blockSize, lane.overlap.data());
+
+        // at a partition boundary the tail is computed anyway
+        if (inputPos > 0)
+            accumulateTail (lane);
+    }
+
+    void rebuildStateFromHistory (Voice& voice)
+    {
+        for (auto* lane : { &voice.current(), &voice.previous() })
+            if (lane->bands != nullptr && (lane == &voice.current() || voice.fading))
+                rebuildLaneState (*lane);
+    }
+
+    /* sum of all but the newest input partition, computed once per partition */
+    void accumulateTail (Lane& lane)
+    {
+        auto* tail = lane.tail.data();
+        std::fill_n (tail, 2 * numBins, 0.0f);
+        for (size_t s = 1; s < lane.numSegments; ++s)
+        {
+            multiplyAccumulate (
+                tail, historySpectrum (omniInput, s), lane.omniSegment (s), numBins);
+            multiplyAccumulate (
+                tail, historySpectrum (eightInput, s), lane.eightSegment (s), numBins);
+        }
+    }
+
+    void processLane (const Voice& voice, Lane& lane, float* out, size_t n, bool fadingOut)
+    {
+        auto* result = lane.result.data();
+
+        std::copy_n (lane.tail.data(), 2 * numBins, accumulator.data());
+        multiplyAccumulate (
+            accumulator.data(), historySpectrum (omniInput, 0), lane.omniSegment (0), numBins);
+        multiplyAccumulate (
+            accumulator.data(), historySpectrum (eightInput, 0), lane.eightSegment (0), numBins);
+        inverseTransform (accumulator.data(), result);
+
+        const auto* overlap = lane.overlap.data();
+        if (! voice.fading)
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = result[inputPos + i] + overlap[inputPos + i];
+            return;
+        }
+
+        // the same ramp as a per band gain ramp from the start to the end weights
+        const auto step = 1.0f / static_cast<float> (voice.fadeLength);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto position = voice.fadePosition + static_cast<int> (i);
+            const auto g = std::min (1.0f, static_cast<float> (position) * step);
+            const auto y = result[inputPos + i] + overlap[inputPos + i];
+            if (fadingOut)
+                out[i] += (1.0f - g) * y;
+            else
+                out[i] = g * y;
+        }
+    }
+
+    void beginPartition()
+    {
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto& voice = voices[static_cast<size_t> (v)];
+            if (! voice.rendering)
+                continue;
+
+            accumulateTail (voice.current());
+            if (voice.fading)
+                accumulateTail (voice.previous());
+        }
+    }
+
+    void endPartition()
+    {
+        for (int v = 0; v < numVoices; ++v)
+        {
+            auto& voice = voices[static_cast<size_t> (v)];
+            if (! voice.rendering)
+                continue;
+
+            for (auto* lane : { &voice.current(), &voice.previous() })
+                if (lane == &voice.current() || voice.fading)
+                    std::copy_n (
+                        lane->result.data() + blockSize, blockSize, lane->overlap.data());
+        }
+
+        for (auto* input : { &omniInput, &eightInput })
+            std::fill (input->buffer.begin(), input->buffer.end(), 0.0f);
+
+        inputPos = 0;
+        head = (head + 1) % numSlots;
+    }
+
+    static constexpr double bandCrossfadeSeconds = 0.02;
+
+    size_t blockSize = 0, fftSize = 0, numBins = 0, maxSegments = 0, numSlots = 1;
+
+    std::unique_ptr<FftBackend> fft;
+    ComplexMultiplyAccumulateFn multiplyAccumulate = complexMultiplyAccumulateScalar;
+    Input omniInput, eightInput;
+    std::span<float> accumulator;
+
+    std::shared_ptr<const PartitionedKernel> bands;
+    std::array<Voice, maxVoices> voices;
+    int numVoices = 1;
+
+    size_t inputPos = 0, head = 0;
+    int bandFadeLength = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixingConvolver)
+};
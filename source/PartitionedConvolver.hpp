@@ -0,0 +1,453 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "ComplexMultiply.hpp"
+#include "FftBackend.hpp"
+#include "ScratchArena.hpp"
+
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+#include <vector>
+
+/* Frequency domain partitions of one or more FIR kernels sharing the same partition size.
+ * Instances are immutable once constructed, so they can be shared between convolvers
+ * (and plugin instances) without any locking.
+ */
+class PartitionedKernel
+{
+public:
+    PartitionedKernel (const juce::AudioBuffer<float>& irs, int irLength, size_t partitionSize) :
+        blockSize (partitionSize),
+        fftSize (2 * partitionSize),
+        numBins (partitionSize + 1),
+        numSegments (static_cast<size_t> (
+            std::max (1, (irLength + static_cast<int> (partitionSize) - 1)
+                             / static_cast<int> (partitionSize)))),
+        numKernels (irs.getNumChannels()),
+        spectra (static_cast<size_t> (numKernels) * numSegments * 2 * numBins, 0.0f)
+    {
+        jassert (juce::isPowerOfTwo (partitionSize));
+
+        auto fft = FftBackend::createFastest (fftSize);
+
+        for (int k = 0; k < numKernels; ++k)
+        {
+            for (size_t s = 0; s < numSegments; ++s)
+            {
+                auto* timeData = fft->getTimeData();
+                std::fill_n (timeData, fftSize, 0.0f);
+                const auto start = static_cast<int> (s * blockSize);
+                const auto len = std::min (static_cast<int> (blockSize), irLength - start);
+                if (len > 0)
+                    juce::FloatVectorOperations::copy (timeData,
+                                                       irs.getReadPointer (k) + start,
+                                                       len);
+
+                fft->forward();
+                std::copy_n (fft->getFrequencyData(), 2 * numBins, getSegmentWritePointer (k, s));
+            }
+        }
+    }
+
+    const float* getSegment (int kernel, size_t segment) const
+    {
+        return spectra.data()
+               + (static_cast<size_t> (kernel) * numSegments + segment) * 2 * numBins;
+    }
+
+    size_t getMemoryUsage() const { return spectra.size() * sizeof (float); }
+
+    const size_t blockSize, fftSize, numBins, numSegments;
+    const int numKernels;
+
+private:
+    float* getSegmentWritePointer (int kernel, size_t segment)
+    {
+        return spectra.data()
+               + (static_cast<size_t> (kernel) * numSegments + segment) * 2 * numBins;
+    }
+
+    std::vector<float> spectra;
+};
+
+/* Uniformly partitioned, zero latency convolution of one input with several kernels.
+ *
+ * All outputs share the frequency domain delay line of the input, so every additional
+ * kernel only costs the spectral accumulation and an inverse transform. As the delay line
+ * only holds input spectra, kernels can be exchanged without losing the convolution
+ * history; a short crossfade takes care of the transition.
+ */
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver() = default;
+
+    /* Allocates all state for the given partition size and drops the current kernel, as it
+     * was partitioned for the previous size. Kernels set later on must not exceed
+     * maxIrLength and maxKernels.
+     */
+    void prepare (size_t partitionSize, int maxIrLength, int maxKernels, double sampleRate)
+    {
+        ownArena.allocate (getScratchSize (partitionSize, maxIrLength, maxKernels));
+        prepare (partitionSize, maxIrLength, maxKernels, sampleRate, ownArena);
+    }
+
+    /* Same as above, but takes the state from the arena of the owner, which must have room
+     * for getScratchSize() bytes and outlive this prepare.
+     */
+    void prepare (size_t partitionSize,
+                  int maxIrLength,
+                  int maxKernels,
+                  double sampleRate,
+                  ScratchArena& arena)
+    {
+        jassert (juce::isPowerOfTwo (partitionSize));
+
+        blockSize = partitionSize;
+        fftSize = 2 * partitionSize;
+        numBins = partitionSize + 1;
+        maxSegments = getNumSegments (partitionSize, maxIrLength);
+        maxOutputs = maxKernels;
+
+        fft = FftBackend::createFastest (fftSize);
+        multiplyAccumulate = getComplexMultiplyAccumulate().function;
+
+        // in the order they are used while processing a partition
+        inputBuffer = arena.take (fftSize);
+        delayLine = arena.take (maxSegments * 2 * numBins);
+        accumulator = arena.take (2 * numBins);
+
+        for (auto& lane : lanes)
+        {
+            lane.allocate (arena, static_cast<size_t> (maxOutputs), numBins, blockSize);
+            lane.kernel.reset();
+        }
+
+        {
+            const juce::SpinLock::ScopedLockType sl (pendingLock);
+            pendingKernel.reset();
+            kernelPending = false;
+        }
+
+        fadeLength = std::max (static_cast<int> (blockSize),
+                               juce::roundToInt (sampleRate * crossfadeSeconds));
+
+        reset();
+    }
+
+    // bytes prepare() takes from an arena
+    static size_t getScratchSize (size_t partitionSize, int maxIrLength, int maxKernels)
+    {
+        const auto bins = partitionSize + 1;
+        const auto outputs = static_cast<size_t> (maxKernels);
+
+        return ScratchArena::getSliceSize (2 * partitionSize)
+               + ScratchArena::getSliceSize (getNumSegments (partitionSize, maxIrLength) * 2 * bins)
+               + ScratchArena::getSliceSize (2 * bins)
+               + 2 * Lane::getScratchSize (outputs, bins, partitionSize);
+    }
+
+    void reset()
+    {
+        std::fill (inputBuffer.begin(), inputBuffer.end(), 0.0f);
+        std::fill (delayLine.begin(), delayLine.end(), 0.0f);
+        for (auto& lane : lanes)
+            lane.clear();
+
+        previous().kernel.reset();
+        inputPos = 0;
+        head = 0;
+        fadePosition = 0;
+        fading = false;
+        hasHistory = false;
+    }
+
+    /* Kernel changes are picked up at the next partition boundary. Can be called from any
+     * thread.
+     */
+    void setKernel (std::shared_ptr<const PartitionedKernel> newKernel)
+    {
+        jassert (newKernel == nullptr
+                 || (newKernel->blockSize == blockSize && newKernel->numSegments <= maxSegments
+                     && newKernel->numKernels <= maxOutputs));
+
+        const juce::SpinLock::ScopedLockType sl (pendingLock);
+        pendingKernel = std::move (newKernel);
+        kernelPending = true;
+    }
+
+    /* Convolves numSamples of input with every kernel of the current PartitionedKernel,
+     * output k receives the result of kernel k. Outputs are left untouched while no kernel
+     * is set. The input may alias one of the outputs.
+     */
+    void process (const float* input, float* const* outputs, size_t numSamples)
+    {
+        size_t done = 0;
+        while (done < numSamples)
+        {
+            if (inputPos == 0)
+                beginPartition();
+
+            const auto n = std::min (numSamples - done, blockSize - inputPos);
+            std::copy_n (input + done, n, inputBuffer.data() + inputPos);
+
+            auto* spectrum = delayLine.data() + head * 2 * numBins;
+            forwardTransform (inputBuffer.data(), spectrum);
+
+            for (int o = 0; o < numKernels (current()); ++o)
+                processLane (current(), o, spectrum, outputs[o] + done, n, false);
+
+            if (fading)
+            {
+                const auto numShared = std::min (numKernels (current()), numKernels (previous()));
+                for (int o = 0; o < numShared; ++o)
+                    processLane (previous(), o, spectrum, outputs[o] + done, n, true);
+
+                fadePosition += static_cast<int> (n);
+                if (fadePosition >= fadeLength)
+                {
+                    fading = false;
+                    previous().kernel.reset();
+                }
+            }
+
+            inputPos += n;
+            done += n;
+            hasHistory = true;
+
+            if (inputPos == blockSize)
+                endPartition();
+        }
+    }
+
+    FftBackendType getFftBackendType() const
+    {
+        return fft != nullptr ? fft->getType() : FftBackendType::juce;
+    }
+
+private:
+    struct Lane
+    {
+        static size_t getScratchSize (size_t numOutputs, size_t bins, size_t block)
+        {
+            return ScratchArena::getSliceSize (numOutputs * 2 * bins)
+                   + ScratchArena::getSliceSize (numOutputs * 2 * block)
+                   + ScratchArena::getSliceSize (numOutputs * block);
+        }
+
+        void allocate (ScratchArena& arena, size_t numOutputs, size_t bins, size_t block)
+        {
+            numBins = bins;
+            blockSize = block;
+            tails = arena.take (numOutputs * 2 * bins);
+            results = arena.take (numOutputs * 2 * block);
+            overlaps = arena.take (numOutputs * block);
+        }
+
+        void clear()
+        {
+            std::fill (tails.begin(), tails.end(), 0.0f);
+            std::fill (overlaps.begin(), overlaps.end(), 0.0f);
+            std::fill (results.begin(), results.end(), 0.0f);
+        }
+
+        float* tail (int o) { return tails.data() + static_cast<size_t> (o) * 2 * numBins; }
+        float* overlap (int o) { return overlaps.data() + static_cast<size_t> (o) * blockSize; }
+        float* result (int o) { return results.data() + static_cast<size_t> (o) * 2 * blockSize; }
+
+        std::shared_ptr<const PartitionedKernel> kernel;
+        std::span<float> tails, overlaps, results;
+        size_t numBins = 0, blockSize = 0;
+    };
+
+    Lane& current() { return lanes[currentLane]; }
+    Lane& previous() { return lanes[1 - currentLane]; }
+
+    static int numKernels (const Lane& lane)
+    {
+        return lane.kernel != nullptr ? lane.kernel->numKernels : 0;
+    }
+
+    static size_t getNumSegments (size_t partitionSize, int irLength)
+    {
+        const auto size = static_cast<int> (partitionSize);
+        return static_cast<size_t> (std::max (1, (irLength + size - 1) / size));
+    }
+
+    const float* historySpectrum (size_t partitionsAgo) const
+    {
+        const auto idx = (head + maxSegments - (partitionsAgo % maxSegments)) % maxSegments;
+        return delayLine.data() + idx * 2 * numBins;
+    }
+
+    void forwardTransform (const float* timeData, float* spectrum)
+    {
+        std::copy_n (timeData, fftSize, fft->getTimeData());
+        fft->forward();
+        std::copy_n (fft->getFrequencyData(), 2 * numBins, spectrum);
+    }
+
+    /* writes the time signal of the given half spectrum into result */
+    void inverseTransform (const float* spectrum, float* result)
+    {
+        std::copy_n (spectrum, 2 * numBins, fft->getFrequencyData());
+        fft->inverse();
+        std::copy_n (fft->getTimeData(), fftSize, result);
+    }
+
+    /* sum of all but the newest input partition, computed once per partition */
+    void accumulateTail (const PartitionedKernel& kernel, int o, float* tail)
+    {
+        std::fill_n (tail, 2 * numBins, 0.0f);
+        for (size_t s = 1; s < kernel.numSegments; ++s)
+            multiplyAccumulate (tail, historySpectrum (s), kernel.getSegment (o, s), numBins);
+    }
+
+    void processLane (Lane& lane, int o, const float* spectrum, float* out, size_t n, bool fadingOut)
+    {
+        auto* result = lane.result (o);
+
+        std::copy_n (lane.tail (o), 2 * numBins, accumulator.data());
+        multiplyAccumulate (accumulator.data(),
+                                   spectrum,
+                                   lane.kernel->getSegment (o, 0),
+                                   numBins);
+        inverseTransform (accumulator.data(), result);
+
+        const auto* overlap = lane.overlap (o);
+        if (! fading)
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = result[inputPos + i] + overlap[inputPos + i];
+            return;
+        }
+
+        const auto step = 1.0f / static_cast<float> (fadeLength);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto g =
+                std::min (1.0f, static_cast<float> (fadePosition + static_cast<int> (i)) * step);
+            const auto y = result[inputPos + i] + overlap[inputPos + i];
+            if (fadingOut)
+                out[i] += (1.0f - g) * y;
+            else
+                out[i] = g * y;
+        }
+    }
+
+    void beginPartition()
+    {
+        {
+            const juce::SpinLock::ScopedTryLockType sl (pendingLock);
+            if (sl.isLocked() && kernelPending)
+            {
+                kernelPending = false;
+                switchKernel (std::move (pendingKernel));
+            }
+        }
+
+        for (auto* lane : { &current(), &previous() })
+        {
+            if (lane == &previous() && ! fading)
+                continue;
+
+            for (int o = 0; o < numKernels (*lane); ++o)
+                accumulateTail (*lane->kernel, o, lane->tail (o));
+        }
+    }
+
+    void endPartition()
+    {
+        for (auto& lane : lanes)
+            for (int o = 0; o < numKernels (lane); ++o)
+                std::copy_n (lane.result (o) + blockSize, blockSize, lane.overlap (o));
+
+        std::fill (inputBuffer.begin(), inputBuffer.end(), 0.0f);
+        inputPos = 0;
+        head = (head + 1) % maxSegments;
+    }
+
+    void switchKernel (std::shared_ptr<const PartitionedKernel> newKernel)
+    {
+        // nothing has been rendered with the old kernel, so there is nothing to fade from
+        const bool needsFade = hasHistory && current().kernel != nullptr && newKernel != nullptr;
+
+        if (needsFade)
+        {
+            currentLane = 1 - currentLane;
+            fading = true;
+            fadePosition = 0;
+        }
+        else
+        {
+            fading = false;
+            previous().kernel.reset();
+        }
+
+        current().kernel = std::move (newKernel);
+
+        for (int o = 0; o < numKernels (current()); ++o)
+            computeOverlapFromHistory (current(), o);
+    }
+
+    /* Reconstructs the overlap of the last partition as if the lane's kernel had
+     * been active all along.
+     */
+    void computeOverlapFromHistory (Lane& lane, int o)
+    {
+        const auto& kernel = *lane.kernel;
+        std::fill (accumulator.begin(), accumulator.end(), 0.0f);
+        for (size_t s = 0; s < kernel.numSegments; ++s)
+            multiplyAccumulate (accumulator.data(),
+                                       historySpectrum (s + 1),
+                                       kernel.getSegment (o, s),
+                                       numBins);
+
+        inverseTransform (accumulator.data(), lane.result (o));
+        std::copy_n (lane.result (o) + blockSize, blockSize, lane.overlap (o));
+    }
+
+    static constexpr double crossfadeSeconds = 0.02;
+
+    size_t blockSize = 0, fftSize = 0, numBins = 0, maxSegments = 0;
+    int maxOutputs = 0;
+
+    std::unique_ptr<FftBackend> fft;
+    ComplexMultiplyAccumulateFn multiplyAccumulate = complexMultiplyAccumulateScalar;
+    ScratchArena ownArena; // only used without an arena from the owner
+    std::span<float> inputBuffer, delayLine, accumulator;
+
+    Lane lanes[2];
+    int currentLane = 0;
+
+    juce::SpinLock pendingLock;
+    std::shared_ptr<const PartitionedKernel> pendingKernel;
+    bool kernelPending = false;
+
+    size_t inputPos = 0, head = 0;
+    int fadeLength = 0, fadePosition = 0;
+    bool fading = false, hasHistory = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
@@ -0,0 +1,55 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "ComplexMultiply.hpp"
+#include "FftBackend.hpp"
+#include "MixKernels.hpp"
+
+#include <atomic>
+#include <juce_core/juce_core.h>
+
+/* What the DSP engine is currently running on. Written by prepareToPlay, can be read from
+ * any thread (e.g. for an about box or support logs).
+ */
+struct PerfCounters
+{
+    std::atomic<FftBackendType> fftBackend { FftBackendType::juce };
+    std::atomic<const char*> complexMultiplyVariant { "" };
+    std::atomic<const char*> mixKernelVariant { "" };
+    std::atomic<int> partitionSize { 0 };
+    std::atomic<int> scratchKilobytes { 0 };
+    std::atomic<bool> scratchLocked { false };
+    std::atomic<int> workerThreads { 0 };
+
+    juce::String toString() const
+    {
+        return "FFT: " + juce::String (FftBackend::getName (fftBackend.load()))
+               + ", complex MAC: " + juce::String (complexMultiplyVariant.load())
+               + ", mix: " + juce::String (mixKernelVariant.load())
+               + ", partition size: " + juce::String (partitionSize.load())
+               + ", scratch: " + juce::String (scratchKilobytes.load()) + " kB"
+               + (scratchLocked.load() ? " (locked)" : "")
+               + ", workers: " + juce::String (workerThreads.load());
+    }
+};
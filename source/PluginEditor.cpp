@@ -1957,14 +1957,14 @@ void PolarDesignerAudioProcessorEditor::activateEditingForZeroLatency()
         saveLayerState (currentLayer);
     }
 
-    valueTreeState.getParameter ("nrBands")->setValueNotifyingHost (
-        valueTreeState.getParameter ("nrBands")->convertTo0to1 (0));
-
-    nEditorBandsChanged();
-
     directivityEqualiser.resetTooltipTexts();
     directivityEqualiser.repaint();
     activateMainUI (false);
+
+    // the bands stay editable, they are split by minimum phase crossovers without latency
+    for (unsigned int i = 0; i < MAX_EDITOR_BANDS; ++i)
+        tmbNrBandsButton[static_cast<int> (i)].setEnabled (true);
+    grpBands.setEnabled (true);
     tmbABButton.setEnabled (false);
     tmbABButton.setVisible (false);
 }
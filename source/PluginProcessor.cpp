@@ -31,6 +31,24 @@
 /* Trim Slider */
 #define PD_PARAMETER_V2 2
 
+/* Filter bank quality and CPU governor */
+#define PD_PARAMETER_V3 3
+
+/* Process wide worker pool */
+#define PD_PARAMETER_V4 4
+
+/* Second virtual microphone */
+#define PD_PARAMETER_V5 5
+
+/* Patterns of the further capsule pairs */
+#define PD_PARAMETER_V6 6
+
+/* Binary state format: magic, format version, then the saveStates ValueTree.
+ * Older sessions stored XML via copyXmlToBinary and are still accepted on load, states of a
+ * newer format version are rejected and the defaults are loaded instead. */
+#define PD_STATE_MAGIC 0x54534450 // "PDST"
+#define PD_STATE_VERSION 1
+
 /* Alternative methods for performance optimization */
 
 #define USE_NEW_UPDATELATENCY
@@ -70,7 +88,7 @@ static juce::AudioProcessorValueTreeState::ParameterLayout
             ParameterID { "xOverF" + String (i + 1), PD_PARAMETER_V1 },
             "Xover" + String (i + 1),
             NormalisableRange<float> (0.0f, 1.0f, 0.0001f),
-            hzToZeroToOne (MAX_NUM_EQS, 0, INIT_XOVER_FREQS_5B[i]),
+            hzToZeroToOne (MAX_NUM_EQS, 0, getBandLayout (MAX_NUM_EQS).initXOverHz[i]),
             AudioParameterFloatAttributes()
                 .withLabel ("Hz")
                 .withCategory (AudioProcessorParameter::genericParameter)
@@ -93,6 +111,19 @@ static juce::AudioProcessorValueTreeState::ParameterLayout
                     [] (float value, [[maybe_unused]] int maximumStringLength)
                     { return String (value, 2); })));
 
+    // pattern of the second output bus, solo and mute are shared with the main output
+    for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
+        layout.add (std::make_unique<APF> (
+            ParameterID { "secondAlpha" + String (i), PD_PARAMETER_V5 },
+            "Second Polar" + String (i),
+            NormalisableRange<float> (-0.5f, 1.0f, 0.01f),
+            0.0f,
+            AudioParameterFloatAttributes()
+                .withCategory (AudioProcessorParameter::genericParameter)
+                .withStringFromValueFunction (
+                    [] (float value, [[maybe_unused]] int maximumStringLength)
+                    { return String (value, 2); })));
+
     for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
         layout.add (
             std::make_unique<APB> (ParameterID { "solo" + String (i), PD_PARAMETER_V1 },
@@ -128,6 +159,49 @@ static juce::AudioProcessorValueTreeState::ParameterLayout
                     [] (float value, [[maybe_unused]] int maximumStringLength)
                     { return String (value, 1); })));
 
+    for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
+        layout.add (std::make_unique<APF> (
+            ParameterID { "secondGain" + String (i), PD_PARAMETER_V5 },
+            "Second Gain" + String (i),
+            NormalisableRange<float> (-24.0f, 18.0f, 0.1f),
+            0.0f,
+            AudioParameterFloatAttributes()
+                .withLabel ("dB")
+                .withCategory (AudioProcessorParameter::genericParameter)
+                .withStringFromValueFunction (
+                    [] (float value, [[maybe_unused]] int maximumStringLength)
+                    { return String (value, 1); })));
+
+    // multi-pair layouts: the first pair plays the main pattern, every further pair its own.
+    // Crossovers, solo, mute, EQ and proximity are shared by all pairs.
+    for (int pair = 2; pair < MAX_NUM_PAIRS + 1; ++pair)
+    {
+        for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
+            layout.add (std::make_unique<APF> (
+                ParameterID { getPairParameterID (pair, "Alpha", i), PD_PARAMETER_V6 },
+                "Pair" + String (pair) + " Polar" + String (i),
+                NormalisableRange<float> (-0.5f, 1.0f, 0.01f),
+                0.0f,
+                AudioParameterFloatAttributes()
+                    .withCategory (AudioProcessorParameter::genericParameter)
+                    .withStringFromValueFunction (
+                        [] (float value, [[maybe_unused]] int maximumStringLength)
+                        { return String (value, 2); })));
+
+        for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
+            layout.add (std::make_unique<APF> (
+                ParameterID { getPairParameterID (pair, "Gain", i), PD_PARAMETER_V6 },
+                "Pair" + String (pair) + " Gain" + String (i),
+                NormalisableRange<float> (-24.0f, 18.0f, 0.1f),
+                0.0f,
+                AudioParameterFloatAttributes()
+                    .withLabel ("dB")
+                    .withCategory (AudioProcessorParameter::genericParameter)
+                    .withStringFromValueFunction (
+                        [] (float value, [[maybe_unused]] int maximumStringLength)
+                        { return String (value, 1); })));
+    }
+
     layout.add (std::make_unique<API> (
         ParameterID { "nrBands", PD_PARAMETER_V1 },
         "Nr. of Bands",
@@ -192,6 +266,37 @@ static juce::AudioProcessorValueTreeState::ParameterLayout
                                           { return value == 0 ? "none" : String (value); })
             .withAutomatable (false)));
 
+    // both change the latency, so they are not automatable
+    layout.add (std::make_unique<AudioParameterChoice> (
+        ParameterID { "filterBankQuality", PD_PARAMETER_V3 },
+        "Filter Bank Quality",
+        StringArray { "Eco", "Standard", "High" },
+        static_cast<int> (FilterBankQuality::standard),
+        AudioParameterChoiceAttributes()
+            .withCategory (AudioProcessorParameter::genericParameter)
+            .withAutomatable (false)));
+
+    layout.add (std::make_unique<APB> (
+        ParameterID { "qualityGovernor", PD_PARAMETER_V3 },
+        "Quality Governor",
+        false,
+        AudioParameterBoolAttributes()
+            .withCategory (AudioProcessorParameter::genericParameter)
+            .withStringFromValueFunction ([] (bool value, [[maybe_unused]] int maximumStringLength)
+                                          { return value ? "on" : "off"; })
+            .withAutomatable (false)));
+
+    // takes effect with the next prepareToPlay
+    layout.add (std::make_unique<APB> (
+        ParameterID { "sharedWorkers", PD_PARAMETER_V4 },
+        "Shared Worker Threads",
+        false,
+        AudioParameterBoolAttributes()
+            .withCategory (AudioProcessorParameter::genericParameter)
+            .withStringFromValueFunction ([] (bool value, [[maybe_unused]] int maximumStringLength)
+                                          { return value ? "on" : "off"; })
+            .withAutomatable (false)));
+
     return layout;
 }
 
@@ -199,7 +304,9 @@ static juce::AudioProcessorValueTreeState::ParameterLayout
 PolarDesignerAudioProcessor::PolarDesignerAudioProcessor() :
     AudioProcessor (BusesProperties()
                         .withInput ("Input", juce::AudioChannelSet::stereo(), true)
-                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
+                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                        .withOutput ("Second Output", juce::AudioChannelSet::stereo(), false)
+                        .withOutput ("Monitor Output", juce::AudioChannelSet::stereo(), false)),
     repaintDEQ (true),
     zeroLatencyModeChanged (true),
     ffDfEqChanged (true),
@@ -233,36 +340,13 @@ PolarDesignerAudioProcessor::PolarDesignerAudioProcessor() :
     undoManager(),
     nProcessorBands (MAX_NUM_EQS),
     vtsParams (*this, &undoManager, "AAPolarDesigner", createParameterLayout (*this)),
-    firLen (FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE),
-    delay(),
-    delayBuffer(),
-    oldDirFactors { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    oldBandGains { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
     isBypassed (false),
-    soloActive (false),
     loadingFile (false),
     readingSharedParams (false),
-    trackingActive (false),
-    trackingDisturber (false),
-    nrBlocksRecorded (0),
-    omniSqSumDist { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    eightSqSumDist { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    omniEightSumDist { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    omniSqSumSig { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    eightSqSumSig { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    omniEightSumSig { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
-    filterBankBuffer(),
-    firFilterBuffer(),
-    omniEightBuffer(),
-    convolvers {},
     lastDir()
 {
     using namespace juce;
 
-    if (firLen % 2 == 0)
-        firLen++;
-    jassert (firLen % 2 == 1); // Ensure firLen is odd
-
     trimPositionPtr = vtsParams.getRawParameterValue ("trimPosition");
 
     for (size_t i = 0; i < MAX_NUM_EQS - 1; ++i)
@@ -274,12 +358,30 @@ PolarDesignerAudioProcessor::PolarDesignerAudioProcessor() :
         soloBandPtr[i] = vtsParams.getRawParameterValue ("solo" + String (i + 1));
         muteBandPtr[i] = vtsParams.getRawParameterValue ("mute" + String (i + 1));
         bandGainsPtr[i] = vtsParams.getRawParameterValue ("gain" + String (i + 1));
+        secondDirFactorsPtr[i] = vtsParams.getRawParameterValue ("secondAlpha" + String (i + 1));
+        secondBandGainsPtr[i] = vtsParams.getRawParameterValue ("secondGain" + String (i + 1));
+    }
+    for (int pair = 2; pair < MAX_NUM_PAIRS + 1; ++pair)
+    {
+        auto& pairPattern = pairPatterns[static_cast<size_t> (pair - 2)];
+        for (size_t i = 0; i < MAX_NUM_EQS; ++i)
+        {
+            pairPattern.dirFactors[i] =
+                vtsParams.getRawParameterValue (getPairParameterID (pair, "Alpha", i + 1));
+            pairPattern.gains[i] =
+                vtsParams.getRawParameterValue (getPairParameterID (pair, "Gain", i + 1));
+        }
     }
     nProcessorBandsPtr = vtsParams.getRawParameterValue ("nrBands");
     proxDistancePtr = vtsParams.getRawParameterValue ("proximity");
     proxOnOffPtr = vtsParams.getRawParameterValue ("proximityOnOff");
     zeroLatencyModePtr = vtsParams.getRawParameterValue ("zeroLatencyMode");
     syncChannelPtr = vtsParams.getRawParameterValue ("syncChannel");
+    filterBankQualityPtr = vtsParams.getRawParameterValue ("filterBankQuality");
+    qualityGovernorPtr = vtsParams.getRawParameterValue ("qualityGovernor");
+    sharedWorkersPtr = vtsParams.getRawParameterValue ("sharedWorkers");
+
+    engines[0] = &dsp;
 
     // properties file: saves user preset folder location
     PropertiesFile::Options options;
@@ -290,10 +392,6 @@ PolarDesignerAudioProcessor::PolarDesignerAudioProcessor() :
 
     registerParameterListeners();
 
-    //    delay.setDelayTime (std::ceilf (static_cast<float> (FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE) / 2 - 1) / FILTER_BANK_NATIVE_SAMPLE_RATE);
-    delay.setDelayTime (static_cast<float> (
-        static_cast<float> ((static_cast<float> (firLen) - 1.0f) / 2.0f) / currentSampleRate));
-
     oldProxDistance = proxDistancePtr->load();
 
     termControlWaveform.setRepaintRate (30);
@@ -308,23 +406,10 @@ PolarDesignerAudioProcessor::PolarDesignerAudioProcessor() :
 
 void PolarDesignerAudioProcessor::registerParameterListeners()
 {
-    static const juce::StringArray params = {
-        "trimPosition", "xOverF1",        "xOverF2",
-        "xOverF3",      "xOverF4",        "alpha1",
-        "alpha2",       "alpha3",         "alpha4",
-        "alpha5",       "solo1",          "solo2",
-        "solo3",        "solo4",          "solo5",
-        "mute1",        "mute2",          "mute3",
-        "mute4",        "mute5",          "gain1",
-        "gain2",        "gain3",          "gain4",
-        "gain5",        "nrBands",        "allowBackwardsPattern",
-        "proximity",    "proximityOnOff", "zeroLatencyMode",
-        "syncChannel",
-    };
-    for (const auto& id : params)
-    {
-        vtsParams.addParameterListener (id, this);
-    }
+    // every parameter is part of the cached state, so none may be left out
+    for (auto* param : getParameters())
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*> (param))
+            vtsParams.addParameterListener (rangedParam->paramID, this);
 }
 
 PolarDesignerAudioProcessor::~PolarDesignerAudioProcessor()
@@ -402,123 +487,9 @@ void PolarDesignerAudioProcessor::changeProgramName ([[maybe_unused]] int index,
 {
 }
 
-void PolarDesignerAudioProcessor::loadEqImpulseResponses()
-{
-    using namespace juce;
-
-    jassert (DF_EQ_LEN == FF_EQ_LEN);
-
-    // nothing changed, return early without allocating memory
-    if (approximatelyEqual (currentSampleRate, previousSampleRate))
-        return;
-
-    AudioBuffer<float> DFEqOmni;
-    AudioBuffer<float> DFEqEight;
-    AudioBuffer<float> FFEqOmni;
-    AudioBuffer<float> FFEqEight;
-
-    // we don't need to resample
-    if (approximatelyEqual (currentSampleRate,
-                            static_cast<double> (FILTER_BANK_NATIVE_SAMPLE_RATE)))
-    {
-        DFEqOmni.setSize (1, DF_EQ_LEN);
-        DFEqEight.setSize (1, DF_EQ_LEN);
-        FFEqOmni.setSize (1, FF_EQ_LEN);
-        FFEqEight.setSize (1, FF_EQ_LEN);
-
-        DFEqOmni.copyFrom (0, 0, DFEQ_COEFFS_OMNI, DF_EQ_LEN);
-        DFEqEight.copyFrom (0, 0, DFEQ_COEFFS_EIGHT, DF_EQ_LEN);
-        FFEqOmni.copyFrom (0, 0, FFEQ_COEFFS_OMNI, FF_EQ_LEN);
-        FFEqEight.copyFrom (0, 0, FFEQ_COEFFS_EIGHT, FF_EQ_LEN);
-
-        eqLatency = 0;
-    }
-
-    // we do need to resample
-    else
-    {
-        WindowedSincInterpolator resampler;
-
-        const auto ratio = FILTER_BANK_NATIVE_SAMPLE_RATE / currentSampleRate;
-        const auto nSamplesRatio = currentSampleRate / FILTER_BANK_NATIVE_SAMPLE_RATE;
-        const auto nSamplesAvailable = DF_EQ_LEN;
-        const auto nSamplesToProduce = static_cast<int> (
-            std::ceil ((nSamplesAvailable + 2 * resampler.getBaseLatency()) * nSamplesRatio));
-
-        DFEqOmni.setSize (1, nSamplesToProduce);
-        DFEqEight.setSize (1, nSamplesToProduce);
-        FFEqOmni.setSize (1, nSamplesToProduce);
-        FFEqEight.setSize (1, nSamplesToProduce);
-
-        resampler.process (ratio,
-                           DFEQ_COEFFS_OMNI,
-                           DFEqOmni.getWritePointer (0),
-                           nSamplesToProduce,
-                           nSamplesAvailable,
-                           0);
-        resampler.reset(); // resampler is stateful, we need to reset it
-
-        resampler.process (ratio,
-                           DFEQ_COEFFS_EIGHT,
-                           DFEqEight.getWritePointer (0),
-                           nSamplesToProduce,
-                           nSamplesAvailable,
-                           0);
-        resampler.reset();
-
-        resampler.process (ratio,
-                           FFEQ_COEFFS_OMNI,
-                           FFEqOmni.getWritePointer (0),
-                           nSamplesToProduce,
-                           nSamplesAvailable,
-                           0);
-        resampler.reset();
-
-        resampler.process (ratio,
-                           FFEQ_COEFFS_EIGHT,
-                           FFEqEight.getWritePointer (0),
-                           nSamplesToProduce,
-                           nSamplesAvailable,
-                           0);
-
-        // resampling requires a power correction
-        {
-            const auto r = static_cast<float> (ratio);
-            DFEqOmni.applyGain (r);
-            DFEqEight.applyGain (r);
-            FFEqOmni.applyGain (r);
-            FFEqEight.applyGain (r);
-        }
-
-        eqLatency = static_cast<int> (std::ceil (resampler.getBaseLatency() * nSamplesRatio));
-    }
-
-    dfEqOmniConv.loadImpulseResponse (std::move (DFEqOmni),
-                                      currentSampleRate,
-                                      dsp::Convolution::Stereo::no,
-                                      dsp::Convolution::Trim::no,
-                                      dsp::Convolution::Normalise::no);
-    dfEqEightConv.loadImpulseResponse (std::move (DFEqEight),
-                                       currentSampleRate,
-                                       dsp::Convolution::Stereo::no,
-                                       dsp::Convolution::Trim::no,
-                                       dsp::Convolution::Normalise::no);
-    ffEqOmniConv.loadImpulseResponse (std::move (FFEqOmni),
-                                      currentSampleRate,
-                                      dsp::Convolution::Stereo::no,
-                                      dsp::Convolution::Trim::no,
-                                      dsp::Convolution::Normalise::no);
-    ffEqEightConv.loadImpulseResponse (std::move (FFEqEight),
-                                       currentSampleRate,
-                                       dsp::Convolution::Stereo::no,
-                                       dsp::Convolution::Trim::no,
-                                       dsp::Convolution::Normalise::no);
-}
-
 void PolarDesignerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     using namespace juce;
-    using namespace dsp;
 
     jassert (FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE > 0);
 
@@ -526,30 +497,24 @@ void PolarDesignerAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     currentSampleRate = sampleRate > 0 ? sampleRate : FILTER_BANK_NATIVE_SAMPLE_RATE;
     currentBlockSize = samplesPerBlock > 0 ? samplesPerBlock : PD_DEFAULT_BLOCK_SIZE;
 
-    // calculate the FIR filter length
-    updateFirLen();
-
-    // Resize buffers
-    resizeBuffersIfNeeded();
-    jassert (firFilterBuffer.getNumSamples() > 0);
+    qualityGovernor.prepare (currentSampleRate);
 
-    // Load EQ and compute filter coefficients
-    loadEqImpulseResponses();
-    computeAllFilterCoefficients();
+    // one engine per capsule pair, the kernels are shared through the kernel store
+    const auto numPairs = getNumPairs (getBusesLayout());
+    while (getNumPairs() < numPairs)
+        pairEngines.push_back (std::make_unique<PolarDesignerDsp>());
+    pairEngines.resize (static_cast<size_t> (numPairs - 1));
+    for (int pair = 1; pair < numPairs; ++pair)
+        engines[static_cast<size_t> (pair)] = pairEngines[static_cast<size_t> (pair - 1)].get();
 
-    // Configure ProcessSpec
-    ProcessSpec spec { currentSampleRate, static_cast<uint32> (currentBlockSize), 1 };
-    dfEqOmniConv.prepare (spec);
-    dfEqEightConv.prepare (spec);
-    ffEqOmniConv.prepare (spec);
-    ffEqEightConv.prepare (spec);
+    const auto numPairWorkers = jlimit (0, numPairs - 1, SystemStats::getNumCpus() - 1);
+    if (pairWorkers.getNumWorkers() != numPairWorkers)
+        pairWorkers.start (numPairWorkers);
 
-    for (auto& conv : convolvers)
-        conv.prepare (spec);
-
-    // Configure delay line
-    delay.prepare (spec);
-    delay.setDelayTime (static_cast<float> (((firLen - 1) / 2.0) / currentSampleRate));
+    // the pools are only switched here, prepareEngine also runs on the audio thread
+    for (int pair = 0; pair < numPairs; ++pair)
+        engines[static_cast<size_t> (pair)]->setSharedWorkers (sharedWorkersPtr->load() > 0.5f);
+    prepareEngine (currentBlockSize);
 
     // Update latency
     updateLatency();
@@ -557,10 +522,77 @@ void PolarDesignerAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     previousSampleRate = currentSampleRate;
 }
 
+void PolarDesignerAudioProcessor::prepareEngine (int blockSize)
+{
+    // offline renders trade the cache friendly quanta for the largest partitions
+    preparedForOffline = isNonRealtime();
+
+    for (int pair = 0; pair < getNumPairs(); ++pair)
+    {
+        auto& engine = *engines[static_cast<size_t> (pair)];
+        engine.setProcessingQuantum (preparedForOffline ? PD_OFFLINE_PROCESSING_QUANTUM
+                                                        : PD_DEFAULT_PROCESSING_QUANTUM);
+
+        // large blocks at high sample rates are shared with worker threads, the workers are
+        // only started once, so re-preparing for an offline render does not touch them.
+        // Several pairs already keep the cores busy on their own.
+        engine.setParallelProcessing (getNumPairs() == 1);
+
+        // the engine requests its kernels for the current settings, until they are ready
+        // processBlock falls back to the delayed single band path
+        engine.setParameters (getDspParameters (pair));
+        engine.prepare (currentSampleRate, blockSize);
+    }
+
+    perfCounters.fftBackend = dsp.getFftBackendType();
+    perfCounters.complexMultiplyVariant = getComplexMultiplyAccumulate().name;
+    perfCounters.mixKernelVariant = getMixKernels().name;
+    perfCounters.partitionSize = static_cast<int> (dsp.getPartitionSize());
+    perfCounters.scratchKilobytes = static_cast<int> (dsp.getScratchMemorySize() / 1024);
+    perfCounters.scratchLocked = dsp.isScratchMemoryLocked();
+    perfCounters.workerThreads =
+        getNumPairs() > 1 ? pairWorkers.getNumWorkers() : dsp.getNumWorkers();
+    LOG_DEBUG (perfCounters.toString());
+}
+
+bool PolarDesignerAudioProcessor::forAllPairs (bool (PolarDesignerDsp::*predicate)() const) const
+{
+    for (int pair = 0; pair < getNumPairs(); ++pair)
+        if (! (engines[static_cast<size_t> (pair)]->*predicate)())
+            return false;
+    return true;
+}
+
+int PolarDesignerAudioProcessor::getNumPairs (const BusesLayout& layouts)
+{
+    const auto numInputs = layouts.getMainInputChannels();
+    if (numInputs <= 2)
+        return 1;
+
+    return numInputs / 2;
+}
+
 bool PolarDesignerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
     using namespace juce;
 
+    // the optional second virtual microphone and the monitor, for single pair layouts only
+    bool auxiliaryOutputs = false;
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+    {
+        const auto set = layouts.getChannelSet (false, bus);
+        if (! set.isDisabled() && set != AudioChannelSet::mono()
+            && set != AudioChannelSet::stereo())
+            return false;
+        auxiliaryOutputs = auxiliaryOutputs || ! set.isDisabled();
+    }
+
+    // multi-pair layouts, a virtual microphone per capsule pair
+    const auto numInputs = layouts.getMainInputChannels();
+    if (numInputs > 2)
+        return numInputs % 2 == 0 && numInputs <= 2 * MAX_NUM_PAIRS
+               && layouts.getMainOutputChannels() == numInputs / 2 && ! auxiliaryOutputs;
+
     if ((layouts.getMainOutputChannelSet() != AudioChannelSet::mono()
          && layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
         || layouts.getMainInputChannelSet() != AudioChannelSet::stereo())
@@ -579,108 +611,140 @@ void PolarDesignerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
                                                 [[maybe_unused]] juce::MidiBuffer& midiMessages)
 {
     using namespace juce;
-    using namespace dsp;
 
     ScopedNoDenormals noDenormals;
+    const auto startTicks = Time::getHighResolutionTicks();
+
     if (isBypassed)
     {
         isBypassed = false;
         updateLatency();
     }
 
-    auto numSamples = static_cast<size_t> (buffer.getNumSamples());
-    createOmniAndEightSignals (buffer);
+    const auto numSamples = buffer.getNumSamples();
 
-    // Proximity compensation
-    auto proximity =
-        juce::approximatelyEqual (proxOnOffPtr->load(), 1.0f) ? proxDistancePtr->load() : 0.f;
-    if (! juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f) && (proximity < -0.05))
+    // Some hosts switch to offline rendering without a new prepareToPlay, or bounce in larger
+    // blocks than announced. Offline there is no deadline, so the engine may be rebuilt here.
+    // Only while its states are silent, then the rebuilt engine continues exactly.
+    if (isNonRealtime() && forAllPairs (&PolarDesignerDsp::isAtRest)
+        && (! preparedForOffline
+            || (numSamples > dsp.getProcessingQuantum()
+                && dsp.getProcessingQuantum() < PD_OFFLINE_PROCESSING_QUANTUM)))
+        prepareEngine (jmax (numSamples, currentBlockSize));
+
+    // Back in realtime without a new prepareToPlay, the engine keeps the offline partitions
+    // until the host prepares again. They cost more per block but produce the same output,
+    // and rebuilding allocates, which neither this thread nor anyone holding the callback lock
+    // may do while audio runs.
+
+    // crossover resets are handled here, the engine follows all other parameter changes itself
+    if (nProcessorBands > 1)
+        recomputeFilterCoefficientsIfNeeded();
+
+    auto params = getDspParameters();
+    const auto numPairs = getNumPairs();
+    for (int pair = 0; pair < numPairs; ++pair)
     {
-        float* writePointerEight = omniEightBuffer.getWritePointer (1);
-        dsp::AudioBlock<float> eightBlock (&writePointerEight, 1, numSamples);
-        dsp::ProcessContextReplacing<float> contextProxEight (eightBlock);
-        proxCompIIR.process (contextProxEight);
+        if (pair > 0)
+            setPairPattern (params, pair);
+        engines[static_cast<size_t> (pair)]->setParameters (params);
+        engines[static_cast<size_t> (pair)]->setNonRealtime (isNonRealtime());
     }
-    else if (! juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f) && (proximity > 0.05))
+
+    // without a position the transport counts as running
+    auto isTransportStopped = false;
+    if (auto* playhead = getPlayHead())
     {
-        float* writePointerOmni = omniEightBuffer.getWritePointer (0);
-        dsp::AudioBlock<float> omniBlock (&writePointerOmni, 1, numSamples);
-        dsp::ProcessContextReplacing<float> contextProxOmni (omniBlock);
-        proxCompIIR.process (contextProxOmni);
+        if (auto position = playhead->getPosition())
+        {
+            playHeadPosition = *position;
+            isTransportStopped = ! position->getIsPlaying() && ! position->getIsRecording();
+        }
     }
 
-    // EQ processing
-    if ((doEq == 1) && ! juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f))
+    termControlWaveform.pushBuffer (buffer);
+
+    if (numPairs > 1)
+    {
+        // every pair writes its virtual microphone into its front channel, so the pairs can run
+        // side by side. The outputs are moved down afterwards, channel p is the front of pair
+        // p / 2, which has been read by then.
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        auto processPair = [&] (int pair)
+        {
+            const auto front = static_cast<size_t> (2 * pair);
+            engines[static_cast<size_t> (pair)]->process (
+                channels[front], channels[front + 1], channels[front], numSamples);
+        };
+        pairWorkers.run (numPairs, processPair);
+
+        for (int pair = 1; pair < numPairs; ++pair)
+            buffer.copyFrom (pair, 0, buffer, 2 * pair, 0, numSamples);
+    }
+    else if (params.secondOutput || params.monitorOutput)
     {
-        float* writePointerOmni = omniEightBuffer.getWritePointer (0);
-        dsp::AudioBlock<float> ffEqOmniBlk (&writePointerOmni, 1, numSamples);
-        dsp::ProcessContextReplacing<float> ffEqOmniCtx (ffEqOmniBlk);
-        ffEqOmniConv.process (ffEqOmniCtx);
-
-        float* writePointerEight = omniEightBuffer.getWritePointer (1);
-        dsp::AudioBlock<float> ffEqEightBlk (&writePointerEight, 1, numSamples);
-        dsp::ProcessContextReplacing<float> ffEqEightCtx (ffEqEightBlk);
-        ffEqEightConv.process (ffEqEightCtx);
+        // with a mono main output the first auxiliary bus starts at the back channel, which the
+        // engine reads before writing
+        auto second = getBusBuffer (buffer, false, 1);
+        auto monitor = getBusBuffer (buffer, false, 2);
+        dsp.process (buffer.getReadPointer (0),
+                     buffer.getReadPointer (1),
+                     buffer.getWritePointer (0),
+                     params.secondOutput ? second.getWritePointer (0) : nullptr,
+                     params.monitorOutput ? monitor.getWritePointer (0) : nullptr,
+                     numSamples);
+
+        for (auto* bus : { &second, &monitor })
+            if (bus->getNumChannels() >= 2)
+                bus->copyFrom (1, 0, *bus, 0, 0, numSamples);
     }
-    else if ((doEq == 2) && ! juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f))
+    else
     {
-        float* writePointerOmni = omniEightBuffer.getWritePointer (0);
-        dsp::AudioBlock<float> dfEqOmniBlk (&writePointerOmni, 1, numSamples);
-        dsp::ProcessContextReplacing<float> dfEqOmniCtx (dfEqOmniBlk);
-        dfEqOmniConv.process (dfEqOmniCtx);
-
-        float* writePointerEight = omniEightBuffer.getWritePointer (1);
-        dsp::AudioBlock<float> dfEqEightBlk (&writePointerEight, 1, numSamples);
-        dsp::ProcessContextReplacing<float> dfEqEightCtx (dfEqEightBlk);
-        dfEqEightConv.process (dfEqEightCtx);
+        dsp.process (buffer.getReadPointer (0),
+                     buffer.getReadPointer (1),
+                     buffer.getWritePointer (0),
+                     numSamples);
     }
 
-    auto nActiveBands = static_cast<int> (nProcessorBands);
-    if (zeroLatencyModePtr->load() > 0.5f)
-        nActiveBands = 1;
+    // copy to second output channel -> this generates loud glitches in pro tools if mono output configuration is used
+    // -> check getMainBusNumOutputChannels() !J!
+    int numOutputChannels = getMainBusNumOutputChannels();
 
-    // Copy input to filter bank
-    for (auto i = 0; i < nActiveBands && 2 * i + 1 < static_cast<int> (convolvers.size()); ++i)
+    if (numPairs == 1 && buffer.getNumChannels() >= 2 && numOutputChannels >= 2)
     {
-        filterBankBuffer.copyFrom (2 * i, 0, omniEightBuffer, 0, 0, buffer.getNumSamples());
-        filterBankBuffer.copyFrom (2 * i + 1, 0, omniEightBuffer, 1, 0, buffer.getNumSamples());
+        buffer.copyFrom (1, 0, buffer, 0, 0, numSamples);
     }
-
-    // Process filter bank convolvers
-    if (zeroLatencyModePtr->load() < 0.5f && nActiveBands > 1)
+    else if (numOutputChannels == 1 && ! params.secondOutput && ! params.monitorOutput)
     {
-        recomputeFilterCoefficientsIfNeeded();
-
-        for (unsigned int i = 0;
-             i < static_cast<size_t> (nActiveBands) && 2 * i + 1 < convolvers.size();
-             ++i)
-        {
-            float* writePointerOmni = filterBankBuffer.getWritePointer (2 * static_cast<int> (i));
-            dsp::AudioBlock<float> subBlk (&writePointerOmni, 1, numSamples);
-            dsp::ProcessContextReplacing<float> filterCtx (subBlk);
-            convolvers[2 * i].process (filterCtx);
-
-            float* writePointerEight =
-                filterBankBuffer.getWritePointer (2 * static_cast<int> (i) + 1);
-            dsp::AudioBlock<float> subBlk2 (&writePointerEight, 1, numSamples);
-            dsp::ProcessContextReplacing<float> filterCtx2 (subBlk2);
-            convolvers[2 * i + 1].process (filterCtx2);
-        }
+        // Ensure mono output is handled cleanly
+        buffer.clear (1, 0, numSamples); // Clear unused channel
     }
-
-    if (auto* playhead = getPlayHead())
+    else if (numOutputChannels == 1 && numPairs == 1)
     {
-        if (auto position = playhead->getPosition())
-        {
-            playHeadPosition = *position;
-        }
+        // the auxiliary buses start at the second channel, the engine has written them already
+    }
+    else if (numPairs == 1)
+    {
+        LOG_ERROR ("Unexpected output channel configuration: " + String (numOutputChannels));
     }
 
-    termControlWaveform.pushBuffer (buffer);
-    if (trackingActive)
-        trackSignalEnergy (buffer.getNumSamples());
-
-    createPolarPatterns (buffer);
+    // offline renders always run at the selected quality. Hosts may not accept a latency
+    // change from the audio thread, the timer reports it.
+    if (qualityGovernorPtr->load() > 0.5f && ! isNonRealtime())
+    {
+        const auto seconds =
+            Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks);
+        if (qualityGovernor.addBlock (seconds,
+                                      numSamples,
+                                      forAllPairs (&PolarDesignerDsp::isIdle),
+                                      isTransportStopped,
+                                      getSelectedQuality()))
+            governorChangedLatency.store (true, std::memory_order_release);
+    }
+    else if (qualityGovernor.reset())
+    {
+        governorChangedLatency.store (true, std::memory_order_release);
+    }
 }
 
 void PolarDesignerAudioProcessor::processBlockBypassed (
@@ -722,6 +786,18 @@ void PolarDesignerAudioProcessor::getStateInformation (juce::MemoryBlock& destDa
 {
     using namespace juce;
 
+    // Hosts ask for the state constantly (autosave, undo snapshots), so only re-serialise
+    // if something has changed since the last call
+    if (! stateDirty.exchange (false, std::memory_order_acq_rel))
+    {
+        const ScopedLock lock (stateCacheLock);
+        if (! stateCache.isEmpty())
+        {
+            destData = stateCache;
+            return;
+        }
+    }
+
     // Update vtsParams.state properties
     vtsParams.state.setProperty ("ffDfEq", var (doEq), nullptr);
     vtsParams.state.setProperty ("oldProxDistance", var (oldProxDistance), nullptr);
@@ -773,8 +849,17 @@ void PolarDesignerAudioProcessor::getStateInformation (juce::MemoryBlock& destDa
     saveStates.addChild (layerA.createCopy(), 1, nullptr);
     saveStates.addChild (layerB.createCopy(), 2, nullptr);
 
-    std::unique_ptr<XmlElement> xml (saveStates.createXml());
-    copyXmlToBinary (*xml, destData);
+    MemoryBlock block;
+    {
+        MemoryOutputStream out (block, false);
+        out.writeInt (PD_STATE_MAGIC);
+        out.writeInt (PD_STATE_VERSION);
+        saveStates.writeToStream (out);
+    }
+
+    const ScopedLock lock (stateCacheLock);
+    stateCache = block;
+    destData = std::move (block);
 
 #ifdef USE_EXTRA_DEBUG_DUMPS
     juce::String treeAsXmlString = saveStates.toXmlString();
@@ -787,18 +872,7 @@ void PolarDesignerAudioProcessor::initializeDefaultState()
 {
     using namespace juce;
 
-    // FIXME: this makes no sense
-    if (approximatelyEqual (currentSampleRate, static_cast<double> (FILTER_BANK_NATIVE_SAMPLE_RATE))
-        && currentBlockSize == PD_DEFAULT_BLOCK_SIZE)
-
-    {
-        LOG_WARN ("Plugin not prepared, initializing with defaults");
-        firLen = FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE;
-        if (firLen % 2 == 0)
-            firLen++;
-        resizeBuffersIfNeeded();
-        //        prepareToPlay(currentSampleRate, currentBlockSize);
-    }
+    stateDirty.store (true, std::memory_order_release);
 
     // Reinitialize ValueTree state
     vtsParams.state = ValueTree ("AAPolarDesigner");
@@ -812,14 +886,10 @@ void PolarDesignerAudioProcessor::initializeDefaultState()
     oldNrBands = oldNrBandsA = oldNrBandsB = 4.0f;
     nProcessorBands = static_cast<unsigned int> (nProcessorBandsPtr ? nProcessorBandsPtr->load() + 1
                                                                     : MAX_NUM_EQS);
-    soloActive = false;
     loadingFile = false;
     readingSharedParams = false;
 
     recomputeAllFilterCoefficients = true;
-
-    for (auto& flag : recomputeFilterCoefficients)
-        flag = false;
     zeroLatencyModeChanged = true;
     ffDfEqChanged = true;
     repaintDEQ.store (true, std::memory_order_relaxed);
@@ -831,32 +901,13 @@ void PolarDesignerAudioProcessor::initializeDefaultState()
     // Define default values based on vtsParams initialization
     // Reset parameters to their default values using stored defaults
     // Define default values based on vtsParams initialization
+    const auto& defaultLayout = getBandLayout (MAX_NUM_EQS);
     std::map<String, float> defaultValues = {
         { "trimPosition", 0.0f }, // Default from constructor: 0.0f
-        { "xOverF1",
-          hzToZeroToOne (
-              nProcessorBands,
-              0,
-              INIT_XOVER_FREQS_5B
-                  [0]) }, // Band 1: Matches constructor, assuming INIT_XOVER_FREQS_5B[0] = 100 Hz
-        { "xOverF2",
-          hzToZeroToOne (
-              nProcessorBands,
-              1,
-              INIT_XOVER_FREQS_5B
-                  [1]) }, // Band 2: Matches constructor, assuming INIT_XOVER_FREQS_5B[1] = 315 Hz
-        { "xOverF3",
-          hzToZeroToOne (
-              nProcessorBands,
-              2,
-              INIT_XOVER_FREQS_5B
-                  [2]) }, // Band 3: Matches constructor, assuming INIT_XOVER_FREQS_5B[2] = 1000 Hz
-        { "xOverF4",
-          hzToZeroToOne (
-              nProcessorBands,
-              3,
-              INIT_XOVER_FREQS_5B
-                  [3]) }, // Band 4: Matches constructor, assuming INIT_XOVER_FREQS_5B[3] = 3150 Hz
+        { "xOverF1", hzToZeroToOne (nProcessorBands, 0, defaultLayout.initXOverHz[0]) }, // Band 1
+        { "xOverF2", hzToZeroToOne (nProcessorBands, 1, defaultLayout.initXOverHz[1]) }, // Band 2
+        { "xOverF3", hzToZeroToOne (nProcessorBands, 2, defaultLayout.initXOverHz[2]) }, // Band 3
+        { "xOverF4", hzToZeroToOne (nProcessorBands, 3, defaultLayout.initXOverHz[3]) }, // Band 4
         { "alpha1", 0.0f }, // Default from constructor: 0.0f (Cardioid)
         { "alpha2", 0.0f }, // Default from constructor: 0.0f
         { "alpha3", 0.0f }, // Default from constructor: 0.0f
@@ -877,20 +928,43 @@ void PolarDesignerAudioProcessor::initializeDefaultState()
         { "gain3", 0.0f }, // Default from constructor: 0.0f
         { "gain4", 0.0f }, // Default from constructor: 0.0f
         { "gain5", 0.0f }, // Default from constructor: 0.0f
+        { "secondAlpha1", 0.0f }, // Default from constructor: 0.0f
+        { "secondAlpha2", 0.0f }, // Default from constructor: 0.0f
+        { "secondAlpha3", 0.0f }, // Default from constructor: 0.0f
+        { "secondAlpha4", 0.0f }, // Default from constructor: 0.0f
+        { "secondAlpha5", 0.0f }, // Default from constructor: 0.0f
+        { "secondGain1", 0.0f }, // Default from constructor: 0.0f (0 dB)
+        { "secondGain2", 0.0f }, // Default from constructor: 0.0f
+        { "secondGain3", 0.0f }, // Default from constructor: 0.0f
+        { "secondGain4", 0.0f }, // Default from constructor: 0.0f
+        { "secondGain5", 0.0f }, // Default from constructor: 0.0f
         { "nrBands", 4.0f }, // Default from constructor: 4 (5 bands, 0-based index)
         { "allowBackwardsPattern", 1.0f }, // Default from constructor: false (0.0f)
         { "proximity", 0.0f }, // Default from constructor: 0.0f
         { "proximityOnOff", 0.0f }, // Default from constructor: false (0.0f)
         { "zeroLatencyMode", 0.0f }, // Default from constructor: false (0.0f)
-        { "syncChannel", 0.0f } // Default from constructor: 0
+        { "syncChannel", 0.0f }, // Default from constructor: 0
+        { "filterBankQuality", 1.0f }, // Default from constructor: 1 (Standard)
+        { "qualityGovernor", 0.0f }, // Default from constructor: false (0.0f)
+        { "sharedWorkers", 0.0f } // Default from constructor: false (0.0f)
     };
 
-    // Apply default values to parameters
+    // the patterns of further pairs, default from constructor: 0.0f
+    for (int pair = 2; pair < MAX_NUM_PAIRS + 1; ++pair)
+    {
+        for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
+        {
+            defaultValues[getPairParameterID (pair, "Alpha", i)] = 0.0f;
+            defaultValues[getPairParameterID (pair, "Gain", i)] = 0.0f;
+        }
+    }
+
+    // Apply default values to parameters, the values above are plain values
     for (const auto& [paramID, defaultValue] : defaultValues)
     {
         if (auto* param = vtsParams.getParameter (paramID))
         {
-            param->setValueNotifyingHost (defaultValue);
+            param->setValueNotifyingHost (param->convertTo0to1 (defaultValue));
 #ifdef USE_EXTRA_DEBUG_DUMPS
             LOG_DEBUG ("Reset parameter " + paramID + " to " + String (defaultValue));
 #endif
@@ -910,92 +984,49 @@ void PolarDesignerAudioProcessor::initializeDefaultState()
     if (juce::approximatelyEqual (currentSampleRate, 0.0))
         currentSampleRate = FILTER_BANK_NATIVE_SAMPLE_RATE; // Default sample rate
 
-    filterBankBuffer.setSize (N_CH_IN * MAX_NUM_EQS, currentBlockSize, false, false, true);
-    firFilterBuffer.setSize (MAX_NUM_EQS, firLen, false, false, true);
-    omniEightBuffer.setSize (MAX_NUM_INPUTS, currentBlockSize, false, false, true);
-
-    for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
-    {
-        oldDirFactors[i] = 0.0f; // Default to cardioid
-        oldBandGains[i] = 0.0f; // Default to 0 dB
-    }
+    // restart the pattern mix from cardioid at 0 dB
+    for (int pair = 0; pair < getNumPairs(); ++pair)
+        engines[static_cast<size_t> (pair)]->resetGainRamps();
 
     // Always true:
     vtsParams.getParameter ("allowBackwardsPattern")->setValueNotifyingHost (1.0f);
 }
-void PolarDesignerAudioProcessor::resizeBuffersIfNeeded()
-{
-    using namespace juce;
-
-    // Resize firFilterBuffer if length differs or is uninitialized
-    if (firFilterBuffer.getNumSamples() != firLen)
-    {
-        firFilterBuffer.setSize (MAX_NUM_EQS, firLen, false, false, true);
-        firFilterBuffer.clear();
-    }
-
-    // Resize filterBankBuffer if channels/samples differ or is uninitialized
-    if (filterBankBuffer.getNumSamples() != currentBlockSize)
-    {
-        filterBankBuffer.setSize (N_CH_IN * MAX_NUM_EQS, currentBlockSize, false, false, true);
-        filterBankBuffer.clear();
-    }
-
-    // Resize omniEightBuffer if channels/samples differ or is uninitialized
-    if (omniEightBuffer.getNumSamples() != currentBlockSize)
-    {
-        omniEightBuffer.setSize (MAX_NUM_INPUTS, currentBlockSize, false, false, true);
-        omniEightBuffer.clear();
-    }
-
-    // Resize delayBuffer if channels/samples differ or is uninitialized
-    if (delayBuffer.getNumSamples() != currentBlockSize)
-    {
-        delayBuffer.setSize (1, currentBlockSize, false, false, true);
-        delayBuffer.clear();
-    }
-}
-
 void PolarDesignerAudioProcessor::releaseResources()
 {
     resetTrackingState();
-    for (auto& conv : convolvers)
-    {
-        conv.reset();
-    }
-    dfEqOmniConv.reset();
-    dfEqEightConv.reset();
-    ffEqOmniConv.reset();
-    ffEqEightConv.reset();
-    proxCompIIR.reset();
-
-    filterBankBuffer.clear();
-    firFilterBuffer.clear();
-    omniEightBuffer.clear();
+    for (int pair = 0; pair < getNumPairs(); ++pair)
+        engines[static_cast<size_t> (pair)]->reset();
 }
 
 void PolarDesignerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     using namespace juce;
 
-    updateFirLen();
-
-    // Initialize if unprepared
-    if (juce::approximatelyEqual (currentSampleRate,
-                                  static_cast<double> (FILTER_BANK_NATIVE_SAMPLE_RATE))
-        && currentBlockSize == PD_DEFAULT_BLOCK_SIZE)
+    // only the parameters are restored here, preparing is left to the host's prepareToPlay.
+    // The engines request the kernels for the restored settings once they are prepared.
+    ValueTree restoredState;
+    if (sizeInBytes > 8 && ByteOrder::littleEndianInt (data) == PD_STATE_MAGIC)
     {
-        LOG_WARN ("Plugin not prepared, initializing with defaults");
-        prepareToPlay (currentSampleRate, currentBlockSize);
+        // we can't know what a newer format means, restoring it half way is worse than the
+        // defaults
+        auto version = ByteOrder::littleEndianInt (addBytesToPointer (data, 4));
+        if (version > PD_STATE_VERSION)
+        {
+            LOG_ERROR ("State was saved by a newer version (format " + String (version) + ")");
+            initializeDefaultState();
+            return;
+        }
+
+        restoredState = ValueTree::readFromData (addBytesToPointer (data, 8),
+                                                 static_cast<size_t> (sizeInBytes - 8));
     }
-    else
+    else if (auto xmlState = getXmlFromBinary (data, sizeInBytes))
     {
-        // Ensure buffers are resized for current sample rate
-        resizeBuffersIfNeeded();
+        // sessions saved before the binary format
+        restoredState = ValueTree::fromXml (*xmlState);
     }
 
-    std::unique_ptr<XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
-    if (! xmlState)
+    if (! restoredState.isValid())
     {
         LOG_ERROR ("Invalid state data");
         initializeDefaultState();
@@ -1003,10 +1034,11 @@ void PolarDesignerAudioProcessor::setStateInformation (const void* data, int siz
     }
 
     resetTrackingState();
+    stateDirty.store (true, std::memory_order_release);
 
-    if (xmlState->hasTagName (saveStates.getType()))
+    if (restoredState.hasType (saveStates.getType()))
     {
-        saveStates = ValueTree::fromXml (*xmlState);
+        saveStates = restoredState;
         if (saveStates.getNumChildren() >= 3)
         {
             layerA = saveStates.getChild (1).createCopy();
@@ -1033,9 +1065,9 @@ void PolarDesignerAudioProcessor::setStateInformation (const void* data, int siz
             abLayerState = COMPARE_LAYER_A;
         }
     }
-    else if (xmlState->hasTagName (vtsParams.state.getType()))
+    else if (restoredState.hasType (vtsParams.state.getType()))
     {
-        vtsParams.state = ValueTree::fromXml (*xmlState);
+        vtsParams.state = restoredState;
         layerA = vtsParams.copyState();
         layerB = vtsParams.copyState();
         if (vtsParams.state.hasProperty ("ABLayer"))
@@ -1146,7 +1178,8 @@ void PolarDesignerAudioProcessor::setStateInformation (const void* data, int siz
                           std::memory_order_release);
     }
 
-    // Defer filter coefficient computation until buffers are ready
+    // the engines request the kernels for the restored settings, they are designed in the
+    // background
     recomputeAllFilterCoefficients.store (true, std::memory_order_relaxed);
     recomputeFilterCoefficientsIfNeeded();
     zeroLatencyModeChanged.store (true, std::memory_order_release);
@@ -1169,6 +1202,8 @@ void PolarDesignerAudioProcessor::parameterChanged (const juce::String& paramete
 {
     using namespace juce;
 
+    stateDirty.store (true, std::memory_order_release);
+
     if (currentSampleRate <= 0.0 || currentBlockSize <= 0)
     {
         LOG_WARN ("Plugin not prepared in parameterChanged, initializing defaults");
@@ -1198,44 +1233,26 @@ void PolarDesignerAudioProcessor::parameterChanged (const juce::String& paramete
             recomputeAllFilterCoefficients.store (true, std::memory_order_relaxed);
         }
     }
-    else if (parameterID.startsWith ("xOverF") && ! loadingFile)
-    {
-        unsigned int idx = static_cast<unsigned int> (parameterID.getTrailingIntValue() - 1);
-        recomputeFilterCoefficients[idx].store (true, std::memory_order_release);
-    }
-    else if (parameterID.startsWith ("solo"))
-    {
-        soloActive = false;
-        for (unsigned int i = 0; i < nProcessorBands; ++i)
-        {
-            // CHANGED: Replaced std::round(soloBandPtr[i]->load()) >= 0.5 with juce::approximatelyEqual(soloBandPtr[i]->load(), 1.0f)
-            if (juce::approximatelyEqual (soloBandPtr[i]->load(), 1.0f))
-                soloActive = true;
-        }
-    }
     else if (parameterID.startsWith ("alpha"))
     {
         repaintDEQ.store (true, std::memory_order_relaxed);
     }
-    else if (parameterID == "proximity")
+    else if (parameterID == "filterBankQuality" || parameterID == "qualityGovernor")
     {
-        setProxCompCoefficients (proxDistancePtr->load());
+        updateLatency();
     }
     else if (parameterID == "zeroLatencyMode")
     {
         updateLatency();
         if (zeroLatencyModePtr->load (std::memory_order_acquire) < 0.5f)
         {
-            // Zero Latency Mode turned off
+            // Zero Latency Mode turned off, the bands are kept as they are
             if (abLayerState == COMPARE_LAYER_B)
             {
                 vtsParams.getParameter ("proximity")
                     ->setValueNotifyingHost (
                         vtsParams.getParameter ("proximity")
                             ->convertTo0to1 (oldProxDistanceB.load (std::memory_order_acquire)));
-                vtsParams.getParameter ("nrBands")->setValueNotifyingHost (
-                    vtsParams.getParameter ("nrBands")->convertTo0to1 (
-                        oldNrBandsB.load (std::memory_order_acquire)));
             }
             else
             {
@@ -1243,35 +1260,26 @@ void PolarDesignerAudioProcessor::parameterChanged (const juce::String& paramete
                     ->setValueNotifyingHost (
                         vtsParams.getParameter ("proximity")
                             ->convertTo0to1 (oldProxDistanceA.load (std::memory_order_acquire)));
-                vtsParams.getParameter ("nrBands")->setValueNotifyingHost (
-                    vtsParams.getParameter ("nrBands")->convertTo0to1 (
-                        oldNrBandsA.load (std::memory_order_acquire)));
             }
-            recomputeAllFilterCoefficients.store (true, std::memory_order_relaxed);
             zeroLatencyModeChanged.store (true, std::memory_order_release);
         }
         else
         {
-            // Zero Latency Mode turned on
+            // Zero Latency Mode turned on, the bands stay, they are split by minimum phase
+            // crossovers instead. There is no proximity compensation without latency.
             if (! abLayerChanged.load (std::memory_order_acquire))
             {
                 if (abLayerState == COMPARE_LAYER_B)
                 {
                     oldProxDistanceB.store (proxDistancePtr->load (std::memory_order_acquire),
                                             std::memory_order_release);
-                    oldNrBandsB.store (nProcessorBandsPtr->load (std::memory_order_acquire),
-                                       std::memory_order_release);
                 }
                 else
                 {
                     oldProxDistanceA.store (proxDistancePtr->load (std::memory_order_acquire),
                                             std::memory_order_release);
-                    oldNrBandsA.store (nProcessorBandsPtr->load (std::memory_order_acquire),
-                                       std::memory_order_release);
                 }
             }
-            vtsParams.getParameter ("nrBands")->setValueNotifyingHost (
-                vtsParams.getParameter ("nrBands")->convertTo0to1 (1));
             vtsParams.getParameter ("proximity")
                 ->setValueNotifyingHost (vtsParams.getParameter ("proximity")->convertTo0to1 (0));
             zeroLatencyModeChanged.store (true, std::memory_order_release);
@@ -1389,6 +1397,7 @@ void PolarDesignerAudioProcessor::parameterChanged (const juce::String& paramete
 void PolarDesignerAudioProcessor::setEqState (int idx)
 {
     doEq = idx;
+    stateDirty.store (true, std::memory_order_release);
 
     if ((syncChannelPtr->load() > 0) && ! readingSharedParams)
     {
@@ -1404,334 +1413,88 @@ void PolarDesignerAudioProcessor::resetXoverFreqs()
 {
     using namespace juce;
 
-    switch (nProcessorBands)
-    {
-        case 1:
-            break;
-
-        case 2:
-            for (unsigned int i = 0; i < nProcessorBands - 1; ++i)
-            {
-                vtsParams.getParameter ("xOverF" + String (i + 1))
-                    ->setValueNotifyingHost (
-                        hzToZeroToOne (nProcessorBands, i, INIT_XOVER_FREQS_2B[i]));
-            }
-            break;
-
-        case 3:
-            for (unsigned int i = 0; i < nProcessorBands - 1; ++i)
-            {
-                vtsParams.getParameter ("xOverF" + String (i + 1))
-                    ->setValueNotifyingHost (
-                        hzToZeroToOne (nProcessorBands, i, INIT_XOVER_FREQS_3B[i]));
-            }
-            break;
-
-        case 4:
-            for (unsigned int i = 0; i < nProcessorBands - 1; ++i)
-            {
-                vtsParams.getParameter ("xOverF" + String (i + 1))
-                    ->setValueNotifyingHost (
-                        hzToZeroToOne (nProcessorBands, i, INIT_XOVER_FREQS_4B[i]));
-            }
-            break;
-
-        case 5:
-            for (unsigned int i = 0; i < (nProcessorBands - 1); ++i)
-            {
-                vtsParams.getParameter ("xOverF" + String (i + 1))
-                    ->setValueNotifyingHost (
-                        hzToZeroToOne (nProcessorBands, i, INIT_XOVER_FREQS_5B[i]));
-            }
-            break;
+    const auto nBands = nProcessorBands.load();
+    jassert (nBands >= 1 && nBands <= MAX_NUM_EQS);
 
-        default:
-            jassert (false);
-            break;
-    }
+    const auto& layout = getBandLayout (nBands);
+    for (unsigned int i = 0; i < layout.getNumCrossovers(); ++i)
+        vtsParams.getParameter ("xOverF" + String (i + 1))
+            ->setValueNotifyingHost (hzToZeroToOne (nBands, i, layout.initXOverHz[i]));
 }
 
 void PolarDesignerAudioProcessor::recomputeFilterCoefficientsIfNeeded()
 {
+    // the engines request the kernels for the reset crossovers themselves
     if (recomputeAllFilterCoefficients.exchange (false, std::memory_order_relaxed))
     {
         resetXoverFreqs();
-        computeAllFilterCoefficients();
         repaintDEQ.store (true, std::memory_order_relaxed);
-        return;
-    }
-
-    for (unsigned int i = 0; i < MAX_NUM_EQS - 1; ++i)
-    {
-        if (recomputeFilterCoefficients[i].exchange (false, std::memory_order_relaxed))
-        {
-            computeFilterCoefficients (i);
-            updateConvolver (i);
-        }
     }
 }
 
-void PolarDesignerAudioProcessor::computeAllFilterCoefficients()
+PolarDesignerDsp::Parameters PolarDesignerAudioProcessor::getDspParameters (int pair) const
 {
-    for (unsigned int i = 0; i < MAX_NUM_EQS - 1; ++i)
-    {
-        computeFilterCoefficients (i);
-    }
-    updateAllConvolvers();
-}
+    PolarDesignerDsp::Parameters params;
 
-void PolarDesignerAudioProcessor::computeFilterCoefficients (unsigned int crossoverNr)
-{
-    using namespace juce;
-    using namespace dsp;
-    if (nProcessorBands == 1)
-        return;
-
-    // Lowest band: lowpass
-    if (crossoverNr == 0)
-    {
-        FilterDesign<float>::FIRCoefficientsPtr lowpass =
-            FilterDesign<float>::designFIRLowpassWindowMethod (
-                hzFromZeroToOne (nProcessorBands, 0, xOverFreqsPtr[0]->load()),
-                currentSampleRate,
-                static_cast<size_t> (firLen - 1),
-                WindowingFunction<float>::WindowingMethod::hamming);
-        firFilterBuffer.copyFrom (0, 0, lowpass->getRawCoefficients(), firLen - 1);
-    }
+    const auto nBands = nProcessorBands.load();
+    params.numBands = nBands;
 
-    // Bandpass filters
-    for (unsigned int i = std::max (1u, crossoverNr);
-         i < std::min (crossoverNr + 2, nProcessorBands - 1);
-         ++i)
-    {
-        const float halfBandwidth =
-            (hzFromZeroToOne (nProcessorBands, i, xOverFreqsPtr[i]->load())
-             - hzFromZeroToOne (nProcessorBands, i - 1, xOverFreqsPtr[i - 1]->load()))
-            / 2;
-        FilterDesign<float>::FIRCoefficientsPtr lp2bp =
-            FilterDesign<float>::designFIRLowpassWindowMethod (
-                halfBandwidth,
-                currentSampleRate,
-                static_cast<size_t> (firLen - 1),
-                WindowingFunction<float>::WindowingMethod::hamming);
-
-        const auto* lp2bpCoeffs = lp2bp->getRawCoefficients();
-        auto* filterBufferPointer = firFilterBuffer.getWritePointer (static_cast<int> (i));
-        const auto fCenter =
-            halfBandwidth + hzFromZeroToOne (nProcessorBands, i - 1, xOverFreqsPtr[i - 1]->load());
-
-        for (int j = 0; j < firLen; j++)
-        {
-            filterBufferPointer[j] = 2 * lp2bpCoeffs[j]
-                                     * std::cos (MathConstants<float>::twoPi * fCenter
-                                                 / static_cast<float> (currentSampleRate)
-                                                 * static_cast<float> (j - (firLen - 1.0) / 2));
-        }
-    }
+    for (unsigned int i = 0; i < MAX_NUM_EQS - 1; ++i)
+        params.xOverHz[i] = i + 1 < nBands ? hzFromZeroToOne (nBands, i, xOverFreqsPtr[i]->load())
+                                           : 0.0f;
 
-    // Highest band: highpass
-    if (crossoverNr == nProcessorBands - 2)
+    for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
     {
-        float hpBandwidth =
-            static_cast<float> (currentSampleRate / 2
-                                - hzFromZeroToOne (nProcessorBands,
-                                                   nProcessorBands - 2,
-                                                   xOverFreqsPtr[nProcessorBands - 2]->load()));
-        auto* filterBufferPointer =
-            firFilterBuffer.getWritePointer (static_cast<int> (nProcessorBands) - 1);
-        dsp::FilterDesign<float>::FIRCoefficientsPtr lp2hp =
-            dsp::FilterDesign<float>::designFIRLowpassWindowMethod (
-                hpBandwidth,
-                currentSampleRate,
-                static_cast<size_t> (firLen - 1),
-                dsp::WindowingFunction<float>::WindowingMethod::hamming);
-        float* lp2hpCoeffs = lp2hp->getRawCoefficients();
-        for (int i = 0; i < firLen; ++i)
-        {
-            filterBufferPointer[i] =
-                lp2hpCoeffs[i]
-                * std::cos (MathConstants<float>::pi
-                            * (static_cast<float> (i) - (static_cast<float> (firLen) - 1.0f) / 2));
-        }
+        params.dirFactors[i] = dirFactorsPtr[i]->load();
+        params.gainsDb[i] = bandGainsPtr[i]->load();
+        params.secondDirFactors[i] = secondDirFactorsPtr[i]->load();
+        params.secondGainsDb[i] = secondBandGainsPtr[i]->load();
+        params.solo[i] = juce::approximatelyEqual (soloBandPtr[i]->load(), 1.0f);
+        params.mute[i] = juce::approximatelyEqual (muteBandPtr[i]->load(), 1.0f);
     }
-}
 
-void PolarDesignerAudioProcessor::updateAllConvolvers()
-{
-    using namespace juce;
+    params.eqMode = doEq;
+    params.proximity =
+        juce::approximatelyEqual (proxOnOffPtr->load(), 1.0f) ? proxDistancePtr->load() : 0.0f;
+    params.zeroLatency = zeroLatencyModePtr->load() > 0.5f;
+    params.quality = qualityGovernor.getQuality (getSelectedQuality());
 
-    const auto nBands = nProcessorBands.load();
-    for (unsigned int i = 0; i < nBands; ++i)
+    const auto isEnabled = [this] (int bus)
     {
-        // Load impulse response only if coefficients changed
-        AudioBuffer<float> convSingleBuff (1, firLen);
-        convSingleBuff.copyFrom (0, 0, firFilterBuffer, static_cast<int> (i), 0, firLen);
-
-        convolvers[2 * i].loadImpulseResponse (std::move (convSingleBuff),
-                                               currentSampleRate,
-                                               dsp::Convolution::Stereo::no,
-                                               dsp::Convolution::Trim::no,
-                                               dsp::Convolution::Normalise::no);
-
-        // Re-create convSingleBuff for second copy since previous was moved
-        convSingleBuff = AudioBuffer<float> (1, firLen);
-        convSingleBuff.copyFrom (0,
-                                 0,
-                                 firFilterBuffer,
-                                 static_cast<int> (i),
-                                 0,
-                                 firLen); // Re-copy for Eight convolver
-        convolvers[2 * i + 1].loadImpulseResponse (std::move (convSingleBuff),
-                                                   currentSampleRate,
-                                                   dsp::Convolution::Stereo::no,
-                                                   dsp::Convolution::Trim::no,
-                                                   dsp::Convolution::Normalise::no);
-    }
+        const auto* outputBus = getBus (false, bus);
+        return outputBus != nullptr && outputBus->isEnabled();
+    };
+    params.secondOutput = isEnabled (1);
+    params.monitorOutput = isEnabled (2);
+    setPairPattern (params, pair);
+    return params;
 }
 
-void PolarDesignerAudioProcessor::updateConvolver (size_t convNr)
+void PolarDesignerAudioProcessor::setPairPattern (PolarDesignerDsp::Parameters& params,
+                                                  int pair) const
 {
-    using namespace juce;
-    using namespace dsp;
-
-    if (currentBlockSize == 0 || currentSampleRate <= 0.0)
-    {
-        LOG_ERROR ("Cannot initialize convolver: invalid block size or sample rate");
-        return;
-    }
-
-    // TODO: ideally we should not allocate the IR holders on the audio thread
-    // prepare impulse response holders
-    std::array<AudioBuffer<float>, 4> convBuffers;
-
-    for (auto i = convNr; i < convNr + 2; ++i)
-    {
-        const auto j = i - convNr;
-        const auto k = j + 2;
-
-        convBuffers[j].setSize (1, firLen);
-        convBuffers[k].setSize (1, firLen);
-
-        convBuffers[j].copyFrom (0, 0, firFilterBuffer, static_cast<int> (i), 0, firLen);
-        convBuffers[k].copyFrom (0, 0, firFilterBuffer, static_cast<int> (i), 0, firLen);
-    }
-
-    for (auto i = convNr; i < convNr + 2; ++i)
+    for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
     {
-        const auto j = i - convNr;
-        const auto k = j + 2;
-
-        // Omni convolver
-        convolvers[2 * i].loadImpulseResponse (std::move (convBuffers[j]),
-                                               currentSampleRate,
-                                               Convolution::Stereo::no, // isStereo
-                                               Convolution::Trim::no, // trim
-                                               Convolution::Normalise::no); // normalise
-
-        // Eight convolver
-        convolvers[2 * i + 1].loadImpulseResponse (std::move (convBuffers[k]),
-                                                   currentSampleRate,
-                                                   Convolution::Stereo::no, // isStereo
-                                                   Convolution::Trim::no, // trim
-                                                   Convolution::Normalise::no); // normalise
+        if (pair == 0)
+        {
+            params.dirFactors[i] = dirFactorsPtr[i]->load();
+            params.gainsDb[i] = bandGainsPtr[i]->load();
+        }
+        else
+        {
+            const auto& pattern = pairPatterns[static_cast<size_t> (pair - 1)];
+            params.dirFactors[i] = pattern.dirFactors[i]->load();
+            params.gainsDb[i] = pattern.gains[i]->load();
+        }
     }
 }
 
-void PolarDesignerAudioProcessor::createOmniAndEightSignals (juce::AudioBuffer<float>& buffer)
+FilterBankQuality PolarDesignerAudioProcessor::getSelectedQuality() const
 {
-    using namespace juce;
-
-    int numSamples = buffer.getNumSamples();
-    // calculate omni part
-    const float* readPointerFront = buffer.getReadPointer (0);
-    const float* readPointerBack = buffer.getReadPointer (1);
-    float* writePointerOmni = omniEightBuffer.getWritePointer (0);
-    FloatVectorOperations::copy (writePointerOmni, readPointerFront, numSamples);
-    FloatVectorOperations::add (writePointerOmni, readPointerBack, numSamples);
-
-    // calculate fig-of-eight part
-    float* writePointerEight = omniEightBuffer.getWritePointer (1);
-    FloatVectorOperations::copy (writePointerEight, readPointerFront, numSamples);
-    FloatVectorOperations::subtract (writePointerEight, readPointerBack, numSamples);
-}
-
-// In createPolarPatterns (around line 1350)
-void PolarDesignerAudioProcessor::createPolarPatterns (juce::AudioBuffer<float>& buffer)
-{
-    using namespace juce;
-
-    int numSamples = buffer.getNumSamples();
-    buffer.clear();
-
-    unsigned int nActiveBands = nProcessorBands;
-    // CHANGED: Replaced std::round(zeroLatencyModePtr->load()) > 0.5f with juce::approximatelyEqual(zeroLatencyModePtr->load(), 1.0f)
-    if (juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f))
-        nActiveBands = 1;
-
-    for (unsigned int i = 0; i < nActiveBands; ++i)
-    {
-        // CHANGED: Replaced std::round(muteBandPtr[i]->load()) > 0.5 && std::round(soloBandPtr[i]->load()) < 0.5
-        // with juce::approximatelyEqual(muteBandPtr[i]->load(), 1.0f) && !juce::approximatelyEqual(soloBandPtr[i]->load(), 1.0f)
-        if ((juce::approximatelyEqual (muteBandPtr[i]->load(), 1.0f)
-             && ! juce::approximatelyEqual (soloBandPtr[i]->load(), 1.0f))
-            || (soloActive && ! juce::approximatelyEqual (soloBandPtr[i]->load(), 1.0f)))
-            continue;
-
-        // calculate patterns and add to output buffer
-        const float* readPointerOmni = filterBankBuffer.getReadPointer (static_cast<int> (2 * i));
-        const float* readPointerEight =
-            filterBankBuffer.getReadPointer (static_cast<int> (2 * i + 1));
-
-        float oldGain = Decibels::decibelsToGain (oldBandGains[i], -59.91f);
-        float gain = Decibels::decibelsToGain (bandGainsPtr[i]->load(), -59.91f);
-
-        // add with ramp to prevent crackling noises
-        buffer.addFromWithRamp (0,
-                                0,
-                                readPointerOmni,
-                                numSamples,
-                                (1 - std::abs (oldDirFactors[i])) * oldGain,
-                                (1 - std::abs (dirFactorsPtr[i]->load())) * gain);
-        buffer.addFromWithRamp (0,
-                                0,
-                                readPointerEight,
-                                numSamples,
-                                oldDirFactors[i] * oldGain,
-                                dirFactorsPtr[i]->load() * gain);
-
-        oldDirFactors[i] = dirFactorsPtr[i]->load();
-        oldBandGains[i] = bandGainsPtr[i]->load();
-    }
-
-    // delay needs to be running constantly to prevent clicks
-    delayBuffer.copyFrom (0, 0, buffer, 0, 0, numSamples);
-    dsp::AudioBlock<float> delayBlock (delayBuffer);
-    dsp::ProcessContextReplacing<float> delayContext (delayBlock);
-    delay.process (delayContext);
-
-    // CHANGED: Replaced std::round(zeroLatencyModePtr->load()) < 0.5f with !juce::approximatelyEqual(zeroLatencyModePtr->load(), 1.0f)
-    if ((nActiveBands == 1) && ! juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f))
-    {
-        buffer.copyFrom (0, 0, delayBuffer, 0, 0, numSamples);
-    }
-
-    // copy to second output channel -> this generates loud glitches in pro tools if mono output configuration is used
-    // -> check getMainBusNumOutputChannels() !J!
-    int numOutputChannels = getMainBusNumOutputChannels();
-
-    if (buffer.getNumChannels() >= 2 && numOutputChannels >= 2)
-    {
-        buffer.copyFrom (1, 0, buffer, 0, 0, numSamples);
-    }
-    else if (numOutputChannels == 1)
-    {
-        // Ensure mono output is handled cleanly
-        buffer.clear (1, 0, numSamples); // Clear unused channel
-    }
-    else
-    {
-        LOG_ERROR ("Unexpected output channel configuration: " + String (numOutputChannels));
-    }
+    return static_cast<FilterBankQuality> (
+        juce::jlimit (0,
+                      NUM_FILTER_BANK_QUALITIES - 1,
+                      juce::roundToInt (filterBankQualityPtr->load())));
 }
 
 juce::Result PolarDesignerAudioProcessor::loadPreset (const juce::File& presetFile)
@@ -1754,6 +1517,7 @@ juce::Result PolarDesignerAudioProcessor::loadPreset (const juce::File& presetFi
     }
 
     loadingFile = true;
+    stateDirty.store (true, std::memory_order_release);
 
     float x = parsedJson.getProperty ("nrActiveBands", parsedJson);
     vtsParams.getParameter ("nrBands")->setValueNotifyingHost (
@@ -1816,7 +1580,6 @@ juce::Result PolarDesignerAudioProcessor::loadPreset (const juce::File& presetFi
     // set parameters
     nProcessorBands = static_cast<unsigned int> (nProcessorBandsPtr->load() + 1);
 
-    computeAllFilterCoefficients();
     repaintDEQ.store (true, std::memory_order_relaxed);
 
     return Result::ok();
@@ -1881,375 +1644,79 @@ juce::Result PolarDesignerAudioProcessor::savePreset (juce::File destination)
 
 float PolarDesignerAudioProcessor::getXoverSliderRangeStart (int sliderNum)
 {
-    switch (nProcessorBands)
-    {
-        case 2:
-            return XOVER_RANGE_START_2B[sliderNum];
-            break;
-
-        case 3:
-            return XOVER_RANGE_START_3B[sliderNum];
-            break;
-
-        case 4:
-            return XOVER_RANGE_START_4B[sliderNum];
-            break;
-
-        case 5:
-            return XOVER_RANGE_START_5B[sliderNum];
-            break;
-
-        default:
-            jassert (false);
-            break;
-    }
-    return 0;
+    const auto& layout = getBandLayout (nProcessorBands);
+    jassert (sliderNum >= 0 && static_cast<unsigned int> (sliderNum) < layout.getNumCrossovers());
+    return layout.xOverRangeStartHz[static_cast<size_t> (sliderNum)];
 }
 
 float PolarDesignerAudioProcessor::getXoverSliderRangeEnd (int sliderNum)
 {
-    switch (nProcessorBands)
-    {
-        case 2:
-            return XOVER_RANGE_END_2B[sliderNum];
-            break;
-
-        case 3:
-            return XOVER_RANGE_END_3B[sliderNum];
-            break;
-
-        case 4:
-            return XOVER_RANGE_END_4B[sliderNum];
-            break;
-
-        case 5:
-            return XOVER_RANGE_END_5B[sliderNum];
-            break;
-
-        default:
-            jassert (false);
-            break;
-    }
-    return 0;
+    const auto& layout = getBandLayout (nProcessorBands);
+    jassert (sliderNum >= 0 && static_cast<unsigned int> (sliderNum) < layout.getNumCrossovers());
+    return layout.xOverRangeEndHz[static_cast<size_t> (sliderNum)];
 }
 
 void PolarDesignerAudioProcessor::startTracking (bool trackDisturber)
 {
-    if (trackDisturber)
-    {
-        trackingDisturber = true;
-        for (size_t i = 0; i < MAX_NUM_EQS; ++i)
-        {
-            omniSqSumDist[i] = 0.0f;
-            eightSqSumDist[i] = 0.0f;
-            omniEightSumDist[i] = 0.0f;
-        }
-    }
-    else
-    {
-        trackingDisturber = false;
-        for (size_t i = 0; i < MAX_NUM_EQS; ++i)
-        {
-            omniSqSumSig[i] = 0.0f;
-            eightSqSumSig[i] = 0.0f;
-            omniEightSumSig[i] = 0.0f;
-        }
-    }
-    nrBlocksRecorded = 0;
-    trackingActive = true;
+    dsp.startTracking (trackDisturber);
 }
 
 void PolarDesignerAudioProcessor::resetTrackingState()
 {
-    trackingActive = false;
-    trackingDisturber = false;
+    dsp.resetTracking();
     signalRecorded = false;
     disturberRecorded = false;
-    nrBlocksRecorded = 0;
-    for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
-    {
-        omniSqSumSig[i] = 0.0f;
-        eightSqSumSig[i] = 0.0f;
-        omniEightSumSig[i] = 0.0f;
-        omniSqSumDist[i] = 0.0f;
-        eightSqSumDist[i] = 0.0f;
-        omniEightSumDist[i] = 0.0f;
-    }
 }
 
 void PolarDesignerAudioProcessor::stopTracking (int applyOptimalPattern)
 {
-    auto normalizeSqSumDist = [this]()
-    {
-        const auto n = static_cast<float> (nrBlocksRecorded);
-
-        for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
-        {
-            omniSqSumDist[i] = omniSqSumDist[i] / n;
-            eightSqSumDist[i] = eightSqSumDist[i] / n;
-            omniEightSumDist[i] = omniEightSumDist[i] / n;
-        }
-    };
-
-    auto normalizeSqSumSig = [this]()
-    {
-        const auto n = static_cast<float> (nrBlocksRecorded);
-
-        for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
-        {
-            omniSqSumSig[i] = omniSqSumSig[i] / n;
-            eightSqSumSig[i] = eightSqSumSig[i] / n;
-            omniEightSumSig[i] = omniEightSumSig[i] / n;
-        }
-    };
-
-    trackingActive = false;
-    if (nrBlocksRecorded == 0)
+    const bool trackedDisturber = dsp.isTrackingDisturber();
+    if (! dsp.stopTracking())
         return; // Skip if no blocks recorded
 
+    const auto nBands = nProcessorBands.load();
+
     if (applyOptimalPattern == 1)
     {
-        if (trackingDisturber)
+        if (trackedDisturber)
         {
-            if (nrBlocksRecorded != 0)
-                normalizeSqSumDist();
-
-            setMinimumDisturbancePattern();
+            if (applyPattern (dsp.getMinimumDisturbancePattern (nBands)))
+                disturberRecorded = true;
         }
         else
         {
-            if (nrBlocksRecorded != 0)
-                normalizeSqSumSig();
-
-            setMaximumSignalPattern();
+            if (applyPattern (dsp.getMaximumSignalPattern (nBands)))
+                signalRecorded = true;
         }
     }
     else if (applyOptimalPattern == 2) // max sig-to-dist
     {
-        if (trackingDisturber)
-        {
-            if (nrBlocksRecorded != 0)
-                normalizeSqSumDist();
-
+        if (trackedDisturber)
             disturberRecorded = true;
-        }
         else
-        {
-            if (nrBlocksRecorded != 0)
-                normalizeSqSumSig();
-
             signalRecorded = true;
-        }
-        maximizeSigToDistRatio();
-    }
-}
 
-void PolarDesignerAudioProcessor::trackSignalEnergy (int numSamples)
-{
-    using namespace juce;
-
-    if (numSamples == 0)
-        return; // avoid division by zero
-
-    for (unsigned int i = 0; i < nProcessorBands; ++i)
-    {
-        const float* readPointerOmni = filterBankBuffer.getReadPointer (static_cast<int> (2 * i));
-        const float* readPointerEight =
-            filterBankBuffer.getReadPointer (static_cast<int> (2 * i + 1));
-        if (trackingDisturber)
-        {
-            for (int j = 0; j < numSamples; ++j)
-            {
-                float omniSample = readPointerOmni[j];
-                omniSqSumDist[i] += omniSample * omniSample / static_cast<float> (numSamples);
-                float eightSample = readPointerEight[j];
-                eightSqSumDist[i] += eightSample * eightSample / static_cast<float> (numSamples);
-                omniEightSumDist[i] += omniSample * eightSample / static_cast<float> (numSamples);
-            }
-        }
-        else
-        {
-            for (int j = 0; j < numSamples; ++j)
-            {
-                float omniSample = readPointerOmni[j];
-                omniSqSumSig[i] += omniSample * omniSample / static_cast<float> (numSamples);
-                float eightSample = readPointerEight[j];
-                eightSqSumSig[i] += eightSample * eightSample / static_cast<float> (numSamples);
-                omniEightSumSig[i] += omniSample * eightSample / static_cast<float> (numSamples);
-            }
-        }
-    }
-    ++nrBlocksRecorded;
-}
-
-void PolarDesignerAudioProcessor::setMinimumDisturbancePattern()
-{
-    using namespace juce;
-
-    float disturberPower = 0.0f;
-    float minPowerAlpha = 0.0f;
-    float alphaStart = 0.0f;
-
-    // !J! NOTE: allowBackwardsPattern is ALWAYS true
-    alphaStart = -0.5f;
-
-    for (unsigned int i = 0; i < nProcessorBands; ++i)
-    {
-        for (float alpha = alphaStart; alpha <= 1.0f; alpha += 0.01f)
-        {
-            float currentPower = std::pow ((1 - std::abs (alpha)), 2.0f) * omniSqSumDist[i]
-                                 + std::pow (alpha, 2.0f) * eightSqSumDist[i]
-                                 + 2 * (1 - std::abs (alpha)) * alpha * omniEightSumDist[i];
-            if (juce::exactlyEqual (alpha, alphaStart) || (currentPower < disturberPower))
-            {
-                disturberPower = currentPower;
-                minPowerAlpha = alpha;
-            }
-        }
-
-        // do not apply changes, if playback is not active
-        if (! juce::exactlyEqual (disturberPower, 0.0f))
-        {
-            vtsParams.getParameter ("alpha" + String (i + 1))
-                ->setValueNotifyingHost (
-                    vtsParams.getParameter ("alpha1")->convertTo0to1 (minPowerAlpha));
-            disturberRecorded = true;
-        }
+        // Skip if both signal and disturber haven't been recorded
+        if (signalRecorded && disturberRecorded)
+            applyPattern (dsp.getMaximumSignalToDisturbanceRatioPattern (nBands));
     }
 }
 
-void PolarDesignerAudioProcessor::setMaximumSignalPattern()
+bool PolarDesignerAudioProcessor::applyPattern (const PolarDesignerDsp::Pattern& pattern)
 {
     using namespace juce;
 
-    float signalPower = 0.0f;
-    float maxPowerAlpha = 0.0f;
-    float alphaStart = -0.5f;
-
-    for (unsigned int i = 0; i < nProcessorBands; ++i)
-    {
-        for (float alpha = alphaStart; alpha <= 1.0f; alpha += 0.01f)
-        {
-            float currentPower = std::pow ((1 - std::abs (alpha)), 2.0f) * omniSqSumSig[i]
-                                 + std::pow (alpha, 2.0f) * eightSqSumSig[i]
-                                 + 2 * (1 - std::abs (alpha)) * alpha * omniEightSumSig[i];
-            if (juce::exactlyEqual (alpha, alphaStart) || (currentPower > signalPower))
-            {
-                signalPower = currentPower;
-                maxPowerAlpha = alpha;
-            }
-        }
-
-        if (! juce::exactlyEqual (signalPower, 0.0f))
-        {
-            vtsParams.getParameter ("alpha" + String (i + 1))
-                ->setValueNotifyingHost (
-                    vtsParams.getParameter ("alpha1")->convertTo0to1 (maxPowerAlpha));
-            signalRecorded = true;
-        }
-    }
-}
-
-void PolarDesignerAudioProcessor::maximizeSigToDistRatio()
-{
-    using namespace juce;
-
-    if (! signalRecorded || ! disturberRecorded)
-        return; // Skip if both signal and disturber haven't been recorded
-
-    for (unsigned int i = 0; i < nProcessorBands; ++i)
-    {
-        if (juce::approximatelyEqual (omniSqSumSig[i], 0.0f)
-            && juce::approximatelyEqual (eightSqSumSig[i], 0.0f)
-            && juce::approximatelyEqual (omniEightSumSig[i], 0.0f)
-            && juce::approximatelyEqual (omniSqSumDist[i], 0.0f)
-            && juce::approximatelyEqual (eightSqSumDist[i], 0.0f)
-            && juce::approximatelyEqual (omniEightSumDist[i], 0.0f))
-            return;
-    }
-
-    float distToSigRatio = 0.0f;
-    float maxDistToSigAlpha = 0.0f;
-    float alphaStart = -0.5f;
-
-    for (unsigned int i = 0; i < nProcessorBands; ++i)
-    {
-        for (float alpha = alphaStart; alpha <= 1.0f; alpha += 0.01f)
-        {
-            float currentSigPower =
-                static_cast<float> (std::pow ((1 - std::abs (alpha)), 2) * omniSqSumSig[i]
-                                    + std::pow (alpha, 2) * eightSqSumSig[i]
-                                    + 2 * (1 - std::abs (alpha)) * alpha * omniEightSumSig[i]);
-            float currentDistPower =
-                static_cast<float> (std::pow ((1 - std::abs (alpha)), 2) * omniSqSumDist[i]
-                                    + std::pow (alpha, 2) * eightSqSumDist[i]
-                                    + 2 * (1 - std::abs (alpha)) * alpha * omniEightSumDist[i]);
-            float currentRatio;
-            if (juce::exactlyEqual (currentDistPower, 0.0f))
-            {
-                currentRatio = 0.0f;
-            }
-            else
-                currentRatio = currentSigPower / currentDistPower;
-
-            if (juce::exactlyEqual (alpha, alphaStart) || (currentRatio > distToSigRatio))
-            {
-                distToSigRatio = currentRatio;
-                maxDistToSigAlpha = alpha;
-            }
-        }
-
-        if (! juce::exactlyEqual (distToSigRatio, 0.0f))
-            vtsParams.getParameter ("alpha" + String (i + 1))
-                ->setValueNotifyingHost (
-                    vtsParams.getParameter ("alpha1")->convertTo0to1 (maxDistToSigAlpha));
-    }
-}
-
-void PolarDesignerAudioProcessor::setProxCompCoefficients (float distance)
-{
-    using namespace juce::dsp::IIR;
-
-    if (std::abs (distance) < 0.0001f)
-    {
-        LOG_WARN ("Invalid proximity distance, using default coefficients");
-        *proxCompIIR.coefficients =
-            Coefficients<float> (1.0f, 0.0f, 1.0f, 0.0f); // Unity gain filter
-        return;
-    }
-
-    auto c = 343.0f;
-    double fs = getSampleRate();
-    if (fs <= 0.0)
+    bool applied = false;
+    for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
     {
-        LOG_WARN ("Invalid sample rate, using default coefficients");
-        *proxCompIIR.coefficients = Coefficients<float> (1.0f, 0.0f, 1.0f, 0.0f);
-        return;
-    }
+        if (! pattern[i].has_value())
+            continue;
 
-    float a = (0.05f - 1.0f) / (-log (1.1f) + log (0.1f));
-    float b = 1.0f + a * log (0.1f);
-    float r = -a * log (std::max (std::abs (distance), 0.0001f)) + b;
-
-    float b0, b1, a0, a1;
-    if (distance <= 0)
-    { // Bass cut
-        r = std::max (r, 0.01f);
-        b0 = static_cast<float> (c * (r - 1.0f) / (fs * 2.0f * r) + 1.0f);
-        b1 = static_cast<float> (-exp (-c / (fs * r)) * (1.0f - c * (r - 1.0f) / (fs * 2.0f * r)));
-        a0 = 1.0f;
-        a1 = static_cast<float> (-exp (-c / (fs * r)));
-    }
-    else
-    { // Bass boost
-        r = std::max (r, 0.05f);
-        b0 = static_cast<float> (c * (1.0f - r) / (fs * 2.0f * r) + 1.0f);
-        b1 = static_cast<float> (-exp (-c / fs) * (1.0f - c * (1.0f - r) / (fs * 2.0f * r)));
-        a0 = 1.0f;
-        a1 = static_cast<float> (-exp (-c / fs));
+        vtsParams.getParameter ("alpha" + String (i + 1))
+            ->setValueNotifyingHost (vtsParams.getParameter ("alpha1")->convertTo0to1 (*pattern[i]));
+        applied = true;
     }
-
-    *proxCompIIR.coefficients = Coefficients<float> (b0, b1, a0, a1);
+    return applied;
 }
 
 void PolarDesignerAudioProcessor::timerCallback()
@@ -2259,6 +1726,10 @@ void PolarDesignerAudioProcessor::timerCallback()
     if (zeroLatencyModeChanged.exchange (false, std::memory_order_acquire))
         updateLatency();
 
+    // the quality governor changes the tier on the audio thread
+    if (governorChangedLatency.exchange (false, std::memory_order_acquire))
+        updateLatency();
+
     if (syncChannelPtr->load (std::memory_order_acquire) > 0)
     {
         readingSharedParams.store (true, std::memory_order_release);
@@ -2360,19 +1831,7 @@ void PolarDesignerAudioProcessor::timerCallback()
 
 void PolarDesignerAudioProcessor::updateLatency()
 {
-    if (isBypassed || juce::approximatelyEqual (zeroLatencyModePtr->load(), 1.0f))
-    {
-        setLatencySamples (0);
-        return;
-    }
-
-    auto latency = (firLen - 1) / 2;
-
-    // we are using free/diffuse field eq
-    if (doEq != 0)
-        latency += eqLatency;
-
-    setLatencySamples (latency);
+    setLatencySamples (isBypassed ? 0 : dsp.getLatencySamples (getDspParameters()));
 }
 
 void PolarDesignerAudioProcessor::changeABLayerState (int state)
@@ -2382,6 +1841,7 @@ void PolarDesignerAudioProcessor::changeABLayerState (int state)
 
     abLayerState = state;
     abLayerChanged.store (true, std::memory_order_release);
+    stateDirty.store (true, std::memory_order_release);
     ffDfEqChanged.store (true, std::memory_order_release);
 
     resetTrackingState(); // Clear tracking data
@@ -2468,18 +1928,6 @@ void PolarDesignerAudioProcessor::changeABLayerState (int state)
 #endif
 }
 
-void PolarDesignerAudioProcessor::updateFirLen()
-{
-    // Calculate firLen
-    int newFirLen = static_cast<int> (
-        std::ceil (static_cast<double> (FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE)
-                   / FILTER_BANK_NATIVE_SAMPLE_RATE * currentSampleRate));
-    if (newFirLen % 2 == 0)
-        newFirLen++;
-    jassert (newFirLen % 2 == 1);
-    firLen = newFirLen;
-}
-
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
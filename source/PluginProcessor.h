@@ -23,12 +23,17 @@
 #pragma once
 
 #include "Constants.hpp"
-#include "resources/Delay.h"
+#include "PerfCounters.hpp"
+#include "QualityGovernor.hpp"
+#include "dsp/PolarDesignerDsp.h"
 
+#include <array>
 #include <atomic>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <math.h>
+#include <memory>
+#include <vector>
 
 // these params can be synced between plugin instances
 struct ParamsToSync
@@ -89,8 +94,6 @@ public:
     juce::String getPageFileName() const override { return "PolarDesigner3.xml"; }
 
     //==============================================================================
-    void loadEqImpulseResponses();
-
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
@@ -157,7 +160,6 @@ public:
     std::atomic<bool> repaintDEQ = true;
     std::atomic<bool> zeroLatencyModeChanged = true;
     std::atomic<bool> ffDfEqChanged = true;
-    std::array<std::atomic<bool>, MAX_NUM_EQS> recomputeFilterCoefficients;
     std::atomic<bool> recomputeAllFilterCoefficients;
 
     bool getDisturberRecorded() { return disturberRecorded; }
@@ -221,6 +223,17 @@ public:
     void timerCallback() override;
 
     juce::AudioProcessorValueTreeState& getValueTreeState() { return vtsParams; }
+    const PerfCounters& getPerfCounters() const { return perfCounters; }
+
+    // capsule pairs of the current layout, 2 N inputs give N virtual microphones
+    int getNumPairs() const { return 1 + static_cast<int> (pairEngines.size()); }
+    static int getNumPairs (const BusesLayout& layouts);
+
+    // pattern parameters of the further pairs, e.g. "pair2Alpha1". Pair 1 uses "alpha1".
+    static juce::String getPairParameterID (int pair, const juce::String& name, size_t band)
+    {
+        return "pair" + juce::String (pair) + name + juce::String (band);
+    }
 
 private:
     //==============================================================================
@@ -231,31 +244,38 @@ private:
     juce::AudioProcessorValueTreeState vtsParams;
     juce::SharedResourcePointer<SharedParams> sharedParams;
 
-    // use odd FIR_LEN for even filter order (FIR_LEN = N+1)
-    // (lowpass and highpass need even filter order to put a zero at f=0 and f=pi)
-    int firLen = FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE;
+    // the signal chain, this class maps the plugin parameters and state onto it
+    PolarDesignerDsp dsp;
 
-    // free field / diffuse field eq
-    juce::dsp::Convolution dfEqOmniConv;
-    juce::dsp::Convolution dfEqEightConv;
-    juce::dsp::Convolution ffEqOmniConv;
-    juce::dsp::Convolution ffEqEightConv;
+    // multi-pair layouts: the signal chains of the further pairs, with the same parameters.
+    // Tracking and the terminator run on the first pair only.
+    std::vector<std::unique_ptr<PolarDesignerDsp>> pairEngines;
+    std::array<PolarDesignerDsp*, MAX_NUM_PAIRS> engines {};
 
-    // proximity compensation filter
-    juce::dsp::IIR::Filter<float> proxCompIIR;
+    // the pairs are processed side by side, each engine stays on one thread
+    WorkerPool pairWorkers;
 
-    // delay (in case of 1 active band)
-    Delay delay;
-    juce::AudioBuffer<float> delayBuffer;
+    // serialised state handed to the host, only rebuilt when something has changed
+    juce::CriticalSection stateCacheLock;
+    juce::MemoryBlock stateCache;
+    std::atomic<bool> stateDirty { true };
 
     std::atomic<float>* nProcessorBandsPtr;
     std::atomic<float>* syncChannelPtr;
     //    float oldSyncChannelPtr;
     std::atomic<float>* xOverFreqsPtr[MAX_NUM_EQS - 1];
     std::atomic<float>* dirFactorsPtr[MAX_NUM_EQS];
-    float oldDirFactors[MAX_NUM_EQS];
     std::atomic<float>* bandGainsPtr[MAX_NUM_EQS];
-    float oldBandGains[MAX_NUM_EQS];
+    std::atomic<float>* secondDirFactorsPtr[MAX_NUM_EQS];
+    std::atomic<float>* secondBandGainsPtr[MAX_NUM_EQS];
+
+    // multi-pair layouts: the patterns of pair 2 and up
+    struct PairPattern
+    {
+        std::atomic<float>* dirFactors[MAX_NUM_EQS];
+        std::atomic<float>* gains[MAX_NUM_EQS];
+    };
+    std::array<PairPattern, MAX_NUM_PAIRS - 1> pairPatterns;
     std::atomic<float>* allowBackwardsPatternPtr;
     // !J! Note: allowBackwardsPatternPtr is being maintained, even though the UI for changing its value has been removed
     // in PolarDesigner3.  The reason for maintenance is for compatability purposes, even though it should ALWAYS be
@@ -270,23 +290,22 @@ private:
 
     std::atomic<float>* trimPositionPtr;
 
+    std::atomic<float>* filterBankQualityPtr;
+    std::atomic<float>* qualityGovernorPtr;
+    std::atomic<float>* sharedWorkersPtr;
+
+    // lowers the filter bank quality while this instance is overloaded
+    QualityGovernor qualityGovernor;
+    std::atomic<bool> governorChangedLatency { false }; // reported by the timer
+
+    // the engine runs with the offline quanta and partitions
+    bool preparedForOffline = false;
+
     bool isBypassed;
-    bool soloActive;
     bool loadingFile;
     std::atomic<bool> readingSharedParams;
-    bool trackingActive;
-    bool trackingDisturber;
-    int nrBlocksRecorded;
-
-    int eqLatency;
-
-    float omniSqSumDist[MAX_NUM_EQS], eightSqSumDist[MAX_NUM_EQS], omniEightSumDist[MAX_NUM_EQS],
-        omniSqSumSig[MAX_NUM_EQS], eightSqSumSig[MAX_NUM_EQS], omniEightSumSig[MAX_NUM_EQS];
 
-    juce::AudioBuffer<float> filterBankBuffer; // holds filtered data, size: N_CH_IN*5
-    juce::AudioBuffer<float> firFilterBuffer; // holds filter coefficients, size: 5
-    juce::AudioBuffer<float> omniEightBuffer; // holds omni and fig-of-eight signals, size: 2
-    std::array<juce::dsp::Convolution, 2 * MAX_NUM_EQS> convolvers;
+    PerfCounters perfCounters;
 
     double currentSampleRate = 0.0f;
     double previousSampleRate = 0.0f;
@@ -296,21 +315,13 @@ private:
     juce::File lastDir;
 
     //==============================================================================
-    void updateFirLen();
-    void resizeBuffersIfNeeded();
     void resetXoverFreqs();
-    void computeAllFilterCoefficients();
-    void computeFilterCoefficients (unsigned int crossoverNr);
-    void setProxCompCoefficients (float distance);
-    void updateAllConvolvers();
-    void updateConvolver (size_t convNr);
-
-    void createOmniAndEightSignals (juce::AudioBuffer<float>& buffer);
-    void createPolarPatterns (juce::AudioBuffer<float>& buffer);
-    void trackSignalEnergy (int numSamples);
-    void setMinimumDisturbancePattern();
-    void setMaximumSignalPattern();
-    void maximizeSigToDistRatio();
+    PolarDesignerDsp::Parameters getDspParameters (int pair = 0) const;
+    void setPairPattern (PolarDesignerDsp::Parameters& params, int pair) const;
+    void prepareEngine (int blockSize);
+    bool forAllPairs (bool (PolarDesignerDsp::*predicate)() const) const;
+    FilterBankQuality getSelectedQuality() const;
+    bool applyPattern (const PolarDesignerDsp::Pattern& pattern);
     void updateLatency();
     void recomputeFilterCoefficientsIfNeeded();
     void resetTrackingState();
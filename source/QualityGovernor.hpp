@@ -0,0 +1,124 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+/* Limits the filter bank quality of one instance by its measured processing load. The load is
+ * the time spent in processBlock relative to the duration of the block. A quality change
+ * changes the latency, so it only happens while the input is silent or the transport is
+ * stopped, never in the middle of the signal. Sustained high load steps the quality down at
+ * the first such boundary. Stepping up again needs a long stretch of low load as well.
+ *
+ * addBlock() and reset() belong to the audio thread, getQuality() may be called from any thread.
+ */
+class QualityGovernor
+{
+public:
+    // share of the real time budget this instance may use before the quality is lowered
+    static constexpr double highLoad = 0.3;
+    // the quality may be raised again while the load stays below this
+    static constexpr double lowLoad = 0.1;
+    static constexpr double stepDownSeconds = 2.0;
+    static constexpr double stepUpSeconds = 10.0;
+    static constexpr double smoothingSeconds = 0.5;
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate > 0 ? newSampleRate : FILTER_BANK_NATIVE_SAMPLE_RATE;
+        reset();
+    }
+
+    // lifts the limit, true if that changes the quality
+    bool reset()
+    {
+        load = 0.0;
+        highLoadSeconds = 0.0;
+        lowLoadSeconds = 0.0;
+        return limit.exchange (FilterBankQuality::high) != FilterBankQuality::high;
+    }
+
+    FilterBankQuality getQuality (FilterBankQuality selected) const
+    {
+        return std::min (selected, limit.load (std::memory_order_relaxed));
+    }
+
+    double getLoad() const { return load; }
+
+    /* call once per processed block, true if the quality changed. The quality only changes
+     * with isIdle or isStopped set, the load is measured while the input is not silent.
+     */
+    bool addBlock (double processingSeconds,
+                   int numSamples,
+                   bool isIdle,
+                   bool isStopped,
+                   FilterBankQuality selected)
+    {
+        if (numSamples <= 0)
+            return false;
+
+        // silent blocks cost next to nothing, they would only hide the load of the rest
+        const auto blockSeconds = numSamples / sampleRate;
+        const auto current = getQuality (selected);
+
+        if (! isIdle)
+        {
+            const auto alpha = 1.0 - std::exp (-blockSeconds / smoothingSeconds);
+            load += alpha * (processingSeconds / blockSeconds - load);
+
+            highLoadSeconds = load > highLoad ? highLoadSeconds + blockSeconds : 0.0;
+            lowLoadSeconds = load < lowLoad ? lowLoadSeconds + blockSeconds : 0.0;
+        }
+
+        if (! isIdle && ! isStopped)
+            return false;
+
+        if (highLoadSeconds >= stepDownSeconds && current != FilterBankQuality::eco)
+        {
+            limit.store (static_cast<FilterBankQuality> (static_cast<int> (current) - 1));
+            highLoadSeconds = 0.0;
+            lowLoadSeconds = 0.0;
+            return true;
+        }
+
+        if (lowLoadSeconds >= stepUpSeconds && current < selected)
+        {
+            limit.store (static_cast<FilterBankQuality> (static_cast<int> (current) + 1));
+            highLoadSeconds = 0.0;
+            lowLoadSeconds = 0.0;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    double sampleRate = FILTER_BANK_NATIVE_SAMPLE_RATE;
+    double load = 0.0;
+    double highLoadSeconds = 0.0, lowLoadSeconds = 0.0;
+    std::atomic<FilterBankQuality> limit { FilterBankQuality::high };
+};
@@ -0,0 +1,117 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <juce_core/juce_core.h>
+#include <new>
+#include <span>
+
+#if ! JUCE_WINDOWS
+    #include <sys/mman.h>
+#endif
+
+/* One contiguous block of cache line aligned scratch memory, handed out in slices.
+ *
+ * The owner adds up the sizes of everything it needs, allocates once while the audio thread
+ * is not running and then takes the slices in processing order, so buffers used after each
+ * other also sit next to each other in memory. The block is zeroed on allocation, which also
+ * faults in every page before the first audio block.
+ */
+class ScratchArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    ScratchArena() = default;
+    ~ScratchArena() { release(); }
+
+    // bytes a slice of numFloats occupies, including the padding to the next cache line
+    static constexpr size_t getSliceSize (size_t numFloats)
+    {
+        return (numFloats * sizeof (float) + alignment - 1) / alignment * alignment;
+    }
+
+    // frees the previous block, all slices taken from it are invalid afterwards
+    void allocate (size_t numBytes)
+    {
+        release();
+
+        size = std::max (alignment, numBytes);
+        data = static_cast<std::byte*> (::operator new (size, std::align_val_t { alignment }));
+        std::memset (data, 0, size);
+        used = 0;
+    }
+
+    std::span<float> take (size_t numFloats)
+    {
+        const auto sliceSize = getSliceSize (numFloats);
+        jassert (data != nullptr && used + sliceSize <= size);
+
+        auto* slice = reinterpret_cast<float*> (data + used);
+        used += sliceSize;
+        return { slice, numFloats };
+    }
+
+    /* Keeps the block in physical memory, so the audio thread never waits for it to be paged
+     * in. Fails without privileges or above RLIMIT_MEMLOCK, the block stays usable then.
+     * Not supported on Windows, where the working set limits make this unreliable.
+     */
+    bool lockPages()
+    {
+#if ! JUCE_WINDOWS
+        if (data != nullptr && ! locked)
+            locked = mlock (data, size) == 0;
+#endif
+        return locked;
+    }
+
+    void release()
+    {
+        if (data == nullptr)
+            return;
+
+#if ! JUCE_WINDOWS
+        if (locked)
+            munlock (data, size);
+#endif
+
+        ::operator delete (data, std::align_val_t { alignment });
+        data = nullptr;
+        size = 0;
+        used = 0;
+        locked = false;
+    }
+
+    size_t getSize() const { return size; }
+    size_t getUsed() const { return used; }
+    bool isLocked() const { return locked; }
+
+private:
+    std::byte* data = nullptr;
+    size_t size = 0, used = 0;
+    bool locked = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScratchArena)
+};
@@ -0,0 +1,285 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <juce_core/juce_core.h>
+#include <memory>
+#include <vector>
+
+#if JUCE_INTEL
+    #include <immintrin.h>
+#endif
+
+/* A few realtime worker threads for fork-join parallelism inside audio callbacks.
+ *
+ * Every caller publishes its job in a slot of its own, up to maxCallers jobs run at the same
+ * time. The tasks of a job are handed out one at a time to whoever asks first: the caller and
+ * any worker, workers take tasks from all jobs alike. A worker that wakes up late finds nothing
+ * left to do, so the caller never waits for a worker that has not started yet: late workers
+ * only cost the parallelism, never the deadline. Once started, a task runs to completion on
+ * its thread. Callers finding all slots taken run their tasks themselves.
+ *
+ * Workers spin for a short while after every job, so back to back jobs are picked up right
+ * away, then they park until the next job. Nothing in run() allocates or locks. start() and
+ * stop() must not be called while a job is running.
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool (int maxCallers = 1) :
+        numSlots (juce::jmax (1, maxCallers)),
+        slots (std::make_unique<Slot[]> (static_cast<size_t> (numSlots)))
+    {
+    }
+
+    ~WorkerPool() { stop(); }
+
+    void start (int numWorkers)
+    {
+        stop();
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            workers.push_back (std::make_unique<Worker> (*this, i));
+            if (! workers.back()->startRealtimeThread (juce::Thread::RealtimeOptions {}))
+                workers.back()->startThread (juce::Thread::Priority::highest);
+        }
+    }
+
+    void stop()
+    {
+        for (auto& worker : workers)
+            worker->signalThreadShouldExit();
+
+        // wake up the parked workers, so they see the exit flag
+        jobSignal.fetch_add (1, std::memory_order_release);
+        jobSignal.notify_all();
+
+        for (auto& worker : workers)
+            worker->stopThread (1000);
+        workers.clear();
+    }
+
+    int getNumWorkers() const { return static_cast<int> (workers.size()); }
+
+    /* Runs task (index) for every index below numTasks and returns once all of them have
+     * finished. The caller works on the job as well, without workers it runs all tasks.
+     * Returns the number of tasks the workers took.
+     */
+    template <typename Task>
+    int run (int numTasks, Task& task)
+    {
+        jassert (numTasks >= 0 && numTasks <= maxTasks);
+
+        auto* slot = numTasks > 1 && ! workers.empty() ? acquireSlot() : nullptr;
+        if (slot == nullptr)
+        {
+            for (int i = 0; i < numTasks; ++i)
+                task (i);
+            return 0;
+        }
+
+        slot->job = { [] (void* context, int index) { (*static_cast<Task*> (context)) (index); },
+                      &task };
+        slot->completed.store (0, std::memory_order_relaxed);
+
+        // publishing the ticket hands out the job, the release orders the job before it
+        const auto generation = ++slot->lastGeneration;
+        slot->ticket.store (makeTicket (generation, static_cast<uint32_t> (numTasks), 0),
+                            std::memory_order_release);
+
+        // parked workers are woken up one by one, there is no point in waking all of them
+        jobSignal.fetch_add (1, std::memory_order_release);
+        const auto numToWake = juce::jmin (numTasks - 1, getNumWorkers());
+        for (int i = 0; i < numToWake; ++i)
+            jobSignal.notify_one();
+
+        const auto byCaller = work (*slot, generation);
+
+        // whatever is still missing has been started by a worker and is about to finish
+        while (slot->completed.load (std::memory_order_acquire) < numTasks)
+            pause();
+
+        slot->busy.store (false, std::memory_order_release);
+        return numTasks - byCaller;
+    }
+
+    // spin iterations of an idle worker before it parks
+    static constexpr int spinIterations = 4000;
+    static constexpr int maxTasks = 0xffff;
+
+private:
+    struct Job
+    {
+        void (*function) (void*, int) = nullptr;
+        void* context = nullptr;
+    };
+
+    // one per concurrent caller, on cache lines of their own
+    struct alignas (64) Slot
+    {
+        std::atomic<bool> busy { false };
+        Job job;
+        uint32_t lastGeneration = 0;
+        std::atomic<uint64_t> ticket { 0 };
+        std::atomic<int> completed { 0 };
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker (WorkerPool& p, int index) :
+            juce::Thread ("PolarDesigner worker " + juce::String (index + 1)),
+            pool (p)
+        {
+        }
+
+        void run() override
+        {
+            auto seen = pool.jobSignal.load (std::memory_order_acquire);
+
+            while (! threadShouldExit())
+            {
+                auto signal = pool.jobSignal.load (std::memory_order_acquire);
+                for (int i = 0; signal == seen && i < spinIterations; ++i)
+                {
+                    pause();
+                    signal = pool.jobSignal.load (std::memory_order_acquire);
+                }
+
+                if (signal == seen)
+                {
+                    pool.jobSignal.wait (seen, std::memory_order_acquire);
+                    continue;
+                }
+
+                seen = signal;
+                while (pool.workOnAnySlot())
+                {
+                }
+            }
+        }
+
+    private:
+        WorkerPool& pool;
+    };
+
+    // generation << 32 | numTasks << 16 | next task
+    static uint64_t makeTicket (uint32_t generation, uint32_t numTasks, uint32_t next)
+    {
+        return (static_cast<uint64_t> (generation) << 32) | (numTasks << 16) | next;
+    }
+
+    static uint32_t generationOf (uint64_t t) { return static_cast<uint32_t> (t >> 32); }
+
+    Slot* acquireSlot()
+    {
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& slot = slots[static_cast<size_t> (i)];
+            if (! slot.busy.load (std::memory_order_relaxed)
+                && ! slot.busy.exchange (true, std::memory_order_acquire))
+                return &slot;
+        }
+        return nullptr;
+    }
+
+    // a task of the given job, false once all of them are taken or the job is over
+    static bool claim (Slot& slot, uint32_t generation, int& index)
+    {
+        auto t = slot.ticket.load (std::memory_order_acquire);
+        for (;;)
+        {
+            const auto next = static_cast<uint32_t> (t & 0xffff);
+            const auto numTasks = static_cast<uint32_t> ((t >> 16) & 0xffff);
+            if (generationOf (t) != generation || next >= numTasks)
+                return false;
+
+            if (slot.ticket.compare_exchange_weak (t, t + 1, std::memory_order_acq_rel))
+            {
+                index = static_cast<int> (next);
+                return true;
+            }
+        }
+    }
+
+    // the job stays valid while one of its tasks is claimed, the caller waits for them
+    static int work (Slot& slot, uint32_t generation)
+    {
+        int index = 0, numDone = 0;
+        while (claim (slot, generation, index))
+        {
+            slot.job.function (slot.job.context, index);
+            slot.completed.fetch_add (1, std::memory_order_acq_rel);
+            ++numDone;
+        }
+        return numDone;
+    }
+
+    // steals the remaining tasks of all running jobs, false if there were none
+    bool workOnAnySlot()
+    {
+        int numDone = 0;
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& slot = slots[static_cast<size_t> (i)];
+            numDone += work (slot, generationOf (slot.ticket.load (std::memory_order_acquire)));
+        }
+        return numDone > 0;
+    }
+
+    static void pause()
+    {
+#if JUCE_INTEL
+        _mm_pause();
+#elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+        __asm__ __volatile__ ("yield");
+#endif
+    }
+
+    const int numSlots;
+    std::unique_ptr<Slot[]> slots;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint32_t> jobSignal { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (WorkerPool)
+};
+
+/* One pool for all instances in the process, for hosts that call many instances from one audio
+ * thread or from a few. Created by the first instance that asks for it, as a
+ * juce::SharedResourcePointer, and stopped with the last one.
+ */
+class SharedWorkerPool : public WorkerPool
+{
+public:
+    // concurrent host threads, more of them process their tasks on their own
+    static constexpr int maxCallers = 16;
+    static constexpr int maxWorkers = 8;
+
+    SharedWorkerPool() : WorkerPool (maxCallers)
+    {
+        start (juce::jlimit (0, maxWorkers, juce::SystemStats::getNumCpus() - 1));
+    }
+};
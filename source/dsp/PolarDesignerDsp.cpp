@@ -0,0 +1,1099 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include "PolarDesignerDsp.h"
+
+#include "Logging.hpp"
+
+#include <tuple>
+#include <utility>
+
+void PolarDesignerDsp::prepare (double newSampleRate, int maximumBlockSize)
+{
+    using namespace juce;
+
+    jassert (FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE > 0);
+
+    // Validate inputs
+    sampleRate = newSampleRate > 0 ? newSampleRate : FILTER_BANK_NATIVE_SAMPLE_RATE;
+    maxBlockSize = maximumBlockSize > 0 ? maximumBlockSize : PD_DEFAULT_BLOCK_SIZE;
+
+    // the stages split in parallel have at most three independent tasks. The shared pool is
+    // created by the first instance using it and runs until the last one lets go.
+    const auto shareWorkers = useWorkers && useSharedWorkers;
+    const auto numWorkers =
+        useWorkers && ! shareWorkers ? jlimit (0, 2, SystemStats::getNumCpus() - 1) : 0;
+    if (workerPool.getNumWorkers() != numWorkers)
+        workerPool.start (numWorkers);
+
+    if (shareWorkers && ! sharedWorkerPool.has_value())
+        sharedWorkerPool.emplace();
+    else if (! shareWorkers)
+        sharedWorkerPool.reset();
+
+    workers = shareWorkers ? &sharedWorkerPool->getObject() : &workerPool;
+    workerStats = {};
+
+    // calculate the FIR filter length, the buffers are sized for the highest quality, so the
+    // quality can change without a new prepare()
+    maxFirLen = getFilterBankLength (sampleRate, FilterBankQuality::high);
+    updateFirLen();
+
+    // host blocks are split into quanta, so the internal buffers never have to grow
+    processingQuantum = jmin (maxBlockSize, maxProcessingQuantum);
+
+    // partitions match the (rounded up) quantum
+    partitionSize = static_cast<size_t> (nextPowerOfTwo (processingQuantum));
+    eqLatency = KernelStore::getEqLatency (sampleRate);
+    eqLength = KernelStore::getEqLength (sampleRate);
+
+    // the single band path is delayed by the latency of the filter bank
+    const auto delayLineSize = static_cast<size_t> (processingQuantum + (maxFirLen - 1) / 2);
+
+    // all scratch memory lives in one arena, laid out in processing order
+    const auto quantum = static_cast<size_t> (processingQuantum);
+    constexpr auto numChannels = MAX_NUM_INPUTS + N_CH_IN * MAX_NUM_BANDS;
+    const auto maxBands = static_cast<int> (MAX_NUM_BANDS);
+    const auto filterBankScratch =
+        PartitionedConvolver::getScratchSize (partitionSize, maxFirLen, maxBands);
+    constexpr auto numOutputs = MixingConvolver::maxVoices;
+    scratch.allocate (numChannels * ScratchArena::getSliceSize (quantum)
+                      + 2 * PartitionedConvolver::getScratchSize (partitionSize, eqLength, 1)
+                      + MixingConvolver::getScratchSize (partitionSize, maxFirLen, numOutputs)
+                      + 2 * filterBankScratch
+                      + numOutputs * ScratchArena::getSliceSize (delayLineSize));
+
+    if (lockScratchMemory && ! scratch.lockPages())
+        LOG_WARN ("Could not lock " + String (scratch.getSize()) + " bytes of scratch memory");
+
+    std::array<float*, numChannels> channels;
+    size_t channel = 0;
+
+    const auto takeChannels = [&] (AudioBuffer<float>& buffer, int num)
+    {
+        const auto first = channel;
+        for (int i = 0; i < num; ++i)
+            channels[channel++] = scratch.take (quantum).data();
+        buffer.setDataToReferTo (channels.data() + first, num, processingQuantum);
+    };
+
+    takeChannels (omniEightBuffer, MAX_NUM_INPUTS);
+
+    eqOmniConv.prepare (partitionSize, eqLength, 1, sampleRate, scratch);
+    eqEightConv.prepare (partitionSize, eqLength, 1, sampleRate, scratch);
+    eqWasActive = false;
+
+    // the second output is switched on and off without a new prepare()
+    bandMixer.prepare (partitionSize, maxFirLen, sampleRate, scratch, numOutputs);
+
+    omniFilterBank.prepare (partitionSize, maxFirLen, maxBands, sampleRate, scratch);
+    eightFilterBank.prepare (partitionSize, maxFirLen, maxBands, sampleRate, scratch);
+    trackingBands = false;
+
+    crossoverFilterBank.prepare (sampleRate, N_CH_IN);
+    crossoversWereActive = false;
+
+    takeChannels (filterBankBuffer, static_cast<int> (N_CH_IN * MAX_NUM_BANDS));
+    delayLine = scratch.take (delayLineSize);
+    secondDelayLine = scratch.take (delayLineSize);
+    delayWritePosition = 0;
+    secondOutputWasActive = false;
+    jassert (scratch.getUsed() == scratch.getSize());
+
+    // Request EQ and filter bank kernels for the new settings, until they are ready
+    // process() falls back to the delayed single band path
+    kernelRequests.clear();
+    requestedFilterBankKey = {};
+    requestedEqKey = {};
+    filterBankKernels.reset();
+    eqKernels.reset();
+    requestKernels (parameters);
+    filterBankOutdated = false;
+    eqOutdated = false;
+
+    // the proximity filter depends on the sample rate
+    proxCompState = 0.0f;
+    setProxCompCoefficients (parameters.proximity);
+
+    silentSamples = 0;
+    idle = false;
+    hasProcessed = false;
+}
+
+void PolarDesignerDsp::reset()
+{
+    bandMixer.reset();
+    omniFilterBank.reset();
+    eightFilterBank.reset();
+    crossoverFilterBank.reset();
+    eqOmniConv.reset();
+    eqEightConv.reset();
+    proxCompState = 0.0f;
+
+    filterBankBuffer.clear();
+    omniEightBuffer.clear();
+    std::fill (delayLine.begin(), delayLine.end(), 0.0f);
+    std::fill (secondDelayLine.begin(), secondDelayLine.end(), 0.0f);
+    delayWritePosition = 0;
+
+    silentSamples = 0;
+    idle = false;
+    hasProcessed = false;
+}
+
+void PolarDesignerDsp::setProcessingQuantum (int maxQuantum)
+{
+    jassert (maxQuantum > 0);
+    maxProcessingQuantum = juce::jmax (1, maxQuantum);
+}
+
+void PolarDesignerDsp::resetGainRamps()
+{
+    oldDirFactors.fill (0.0f); // cardioid
+    oldBandGains.fill (0.0f); // 0 dB
+    oldSecondDirFactors.fill (0.0f);
+    oldSecondBandGains.fill (0.0f);
+}
+
+void PolarDesignerDsp::setParameters (const Parameters& newParameters)
+{
+    jassert (newParameters.numBands >= 1 && newParameters.numBands <= MAX_NUM_BANDS);
+
+    const auto qualityChanged = newParameters.quality != parameters.quality;
+    if (newParameters.numBands != parameters.numBands
+        || newParameters.xOverHz != parameters.xOverHz || qualityChanged)
+        filterBankOutdated = true;
+
+    if (newParameters.eqMode != parameters.eqMode)
+        eqOutdated = true;
+
+    if (! juce::exactlyEqual (newParameters.proximity, proxCompDistance))
+        setProxCompCoefficients (newParameters.proximity);
+
+    parameters = newParameters;
+    parameters.numBands = juce::jlimit (1u, MAX_NUM_BANDS, parameters.numBands);
+
+    // the latency follows right away, the filter bank falls back to the single band path until
+    // the kernels of the new length are ready
+    if (qualityChanged && isPrepared())
+        updateFirLen();
+
+    soloActive = false;
+    for (unsigned int i = 0; i < parameters.numBands; ++i)
+        soloActive = soloActive || parameters.solo[i];
+}
+
+void PolarDesignerDsp::requestKernels (const Parameters& params)
+{
+    requestEq (params, false);
+    requestFilterBank (params, false);
+}
+
+void PolarDesignerDsp::process (const float* front,
+                                const float* back,
+                                float* output,
+                                float* secondOutput,
+                                float* monitorOutput,
+                                int numSamples)
+{
+    using namespace juce;
+
+    jassert (isPrepared());
+
+    ScopedNoDenormals noDenormals;
+
+    BlockSettings block;
+    block.eqActive =
+        (parameters.eqMode == 1 || parameters.eqMode == 2) && ! parameters.zeroLatency;
+    block.nActiveBands = parameters.numBands;
+    block.runFilterBank = block.nActiveBands > 1 && ! parameters.zeroLatency;
+    block.runCrossovers = block.nActiveBands > 1 && parameters.zeroLatency;
+    block.secondOutput = parameters.secondOutput && secondOutput != nullptr;
+    block.monitorOutput = parameters.monitorOutput && monitorOutput != nullptr;
+    block.length = numSamples;
+
+    if (! parameters.zeroLatency && parameters.proximity < -0.05f)
+        block.proximity = ProximitySide::eight;
+    else if (! parameters.zeroLatency && parameters.proximity > 0.05f)
+        block.proximity = ProximitySide::omni;
+
+    // request kernels for changed settings and pick up the ones that are ready. Realtime the
+    // requests are only queued, a full queue is tried again with the next block. Offline
+    // renders have to be exact, so they request right away and wait for the design instead of
+    // falling back.
+    const auto queued = ! waitForKernels;
+    if (block.eqActive && eqOutdated)
+        eqOutdated = ! requestEq (parameters, queued);
+    if (block.runFilterBank && filterBankOutdated)
+        filterBankOutdated = ! requestFilterBank (parameters, queued);
+    applyPendingKernels (waitForKernels);
+
+    // the EQ convolvers did not see any input while inactive, start over from silence
+    if (block.eqActive && ! eqWasActive)
+    {
+        eqOmniConv.reset();
+        eqEightConv.reset();
+    }
+    eqWasActive = block.eqActive;
+
+    block.filterBankReady =
+        ! block.runFilterBank
+        || (filterBankKernels != nullptr
+            && filterBankKernels->firs.getNumChannels() == static_cast<int> (block.nActiveBands)
+            && filterBankKernels->firs.getNumSamples() == firLen);
+    if (! block.filterBankReady)
+        block.nActiveBands = 1;
+
+    // the monitor splits the bands the main output plays with the crossovers, unless those
+    // split the main output already
+    block.monitorCrossovers =
+        block.monitorOutput && ! parameters.zeroLatency && block.nActiveBands > 1;
+
+    // the crossovers follow any change right away, they start from silence when switched on
+    const auto crossoversActive = block.runCrossovers || block.monitorCrossovers;
+    if (crossoversActive)
+    {
+        if (! crossoversWereActive)
+            crossoverFilterBank.reset();
+        crossoverFilterBank.setCrossovers (block.nActiveBands, parameters.xOverHz);
+    }
+    crossoversWereActive = crossoversActive;
+
+    for (unsigned int i = 0; i < block.nActiveBands; ++i)
+        if (isBandAudible (i))
+            block.audibleBands[block.numAudibleBands++] = i;
+
+    // everything branching on the settings is resolved here, the quanta run specialised code
+    block.rampedMix = mixKernels.rampedMix[block.numAudibleBands];
+    block.processQuantum = getQuantumProcessor (block.proximity, block.eqActive);
+
+    // the second pattern starts right at its weights, from silence
+    if (block.secondOutput && ! secondOutputWasActive)
+    {
+        std::fill (secondDelayLine.begin(), secondDelayLine.end(), 0.0f);
+        oldSecondDirFactors = parameters.secondDirFactors;
+        oldSecondBandGains = parameters.secondGainsDb;
+    }
+    secondOutputWasActive = block.secondOutput;
+
+    if (detectIdle (front, back, numSamples, block))
+    {
+        FloatVectorOperations::clear (output, numSamples);
+        if (secondOutput != nullptr)
+            FloatVectorOperations::clear (secondOutput, numSamples);
+        if (monitorOutput != nullptr)
+            FloatVectorOperations::clear (monitorOutput, numSamples);
+        commitGainRamps (block);
+        return;
+    }
+
+    if (block.runFilterBank && block.filterBankReady)
+        updateBandMixer (block);
+
+    // the band signals start from silence when tracking starts, which doesn't matter for the
+    // energies averaged over the whole recording. Muted and non-soloed bands are tracked as
+    // well, their patterns are still offered, so every band convolution runs here.
+    block.trackBands = trackingActive && block.runFilterBank && block.nActiveBands > 1;
+    if (block.trackBands && ! trackingBands)
+    {
+        omniFilterBank.reset();
+        eightFilterBank.reset();
+    }
+    trackingBands = block.trackBands;
+
+    planTasks (block);
+    hasProcessed = true;
+
+    // the sub-blocks only read input ahead of what they write, so output may alias front and
+    // one of the second and the monitor output may alias back
+    for (int offset = 0; offset < numSamples; offset += processingQuantum)
+    {
+        const auto n = jmin (processingQuantum, numSamples - offset);
+        (this->*block.processQuantum) (front + offset,
+                                       back + offset,
+                                       output + offset,
+                                       block.secondOutput ? secondOutput + offset : nullptr,
+                                       block.monitorOutput ? monitorOutput + offset : nullptr,
+                                       offset,
+                                       n,
+                                       block);
+    }
+
+    if (secondOutput != nullptr && ! block.secondOutput)
+        FloatVectorOperations::clear (secondOutput, numSamples);
+    if (monitorOutput != nullptr && ! block.monitorOutput)
+        FloatVectorOperations::clear (monitorOutput, numSamples);
+
+    commitGainRamps (block);
+}
+
+PolarDesignerDsp::OutputPattern PolarDesignerDsp::getOutputPattern (int outputIndex)
+{
+    if (outputIndex == 0)
+        return { parameters.dirFactors, parameters.gainsDb, oldDirFactors, oldBandGains };
+
+    return { parameters.secondDirFactors,
+             parameters.secondGainsDb,
+             oldSecondDirFactors,
+             oldSecondBandGains };
+}
+
+void PolarDesignerDsp::commitGainRamps (const BlockSettings& block)
+{
+    // the ramps of muted bands continue from where they stopped
+    for (int o = 0; o < (block.secondOutput ? 2 : 1); ++o)
+    {
+        const auto pattern = getOutputPattern (o);
+        for (unsigned int b = 0; b < block.numAudibleBands; ++b)
+        {
+            const auto i = block.audibleBands[b];
+            pattern.oldDirFactors[i] = pattern.dirFactors[i];
+            pattern.oldGainsDb[i] = pattern.gainsDb[i];
+        }
+    }
+}
+
+void PolarDesignerDsp::planTasks (BlockSettings& block) const
+{
+    using namespace juce;
+
+    if (block.runFilterBank)
+        block.bandTasks[static_cast<size_t> (block.numBandTasks++)] = BandTask::mixer;
+    if (block.trackBands)
+    {
+        block.bandTasks[static_cast<size_t> (block.numBandTasks++)] = BandTask::omniFilterBank;
+        block.bandTasks[static_cast<size_t> (block.numBandTasks++)] = BandTask::eightFilterBank;
+    }
+    if (block.runCrossovers)
+    {
+        block.bandTasks[static_cast<size_t> (block.numBandTasks++)] = BandTask::omniCrossovers;
+        block.bandTasks[static_cast<size_t> (block.numBandTasks++)] = BandTask::eightCrossovers;
+    }
+
+    if (getNumWorkers() == 0)
+        return;
+
+    // probing the workers again once the back-off has passed
+    if (workerStats.backOffSamples > 0)
+    {
+        workerStats.backOffSamples -= block.length;
+        return;
+    }
+
+    // flops per sample, a 4th order Linkwitz-Riley section takes about 25
+    const auto bands = static_cast<int> (block.nActiveBands);
+    const auto crossoverCost = 25.0f * static_cast<float> ((bands - 1) * bands / 2);
+    const auto getTaskCost = [&] (BandTask task)
+    {
+        switch (task)
+        {
+            case BandTask::mixer:
+                // two inputs and one more inverse transform for the second output, the
+                // crossfades are left out
+                return (block.secondOutput ? 3.0f : 2.0f)
+                       * getConvolutionCost (partitionSize, firLen, 1);
+            case BandTask::omniFilterBank:
+            case BandTask::eightFilterBank:
+                return getConvolutionCost (partitionSize, firLen, bands);
+            case BandTask::omniCrossovers:
+            case BandTask::eightCrossovers:
+                return crossoverCost;
+        }
+        return 0.0f;
+    };
+
+    // the first quantum of the block is the longest
+    const auto n = static_cast<float> (jmin (block.length, processingQuantum));
+
+    if (block.eqActive)
+        block.parallelEq =
+            n * getConvolutionCost (partitionSize, eqLength, 1) >= PD_PARALLEL_WORK_THRESHOLD;
+
+    // the caller keeps the largest task, the others are handed off
+    float total = 0.0f, largest = 0.0f;
+    for (int i = 0; i < block.numBandTasks; ++i)
+    {
+        const auto cost = getTaskCost (block.bandTasks[static_cast<size_t> (i)]);
+        total += cost;
+        largest = jmax (largest, cost);
+    }
+    block.parallelBands = n * (total - largest) >= PD_PARALLEL_WORK_THRESHOLD;
+}
+
+float PolarDesignerDsp::getConvolutionCost (size_t partitionSize, int irLength, int numOutputs)
+{
+    // per partition one forward and numOutputs inverse real FFTs of 2.5 N log2 N flops each,
+    // and a complex multiply-add per bin, segment and output
+    const auto size = static_cast<float> (partitionSize);
+    const auto segments = std::ceil (static_cast<float> (irLength) / size);
+    const auto outputs = static_cast<float> (numOutputs);
+    return (1.0f + outputs) * 5.0f * std::log2 (2.0f * size) + outputs * 8.0f * segments;
+}
+
+template <typename Task>
+void PolarDesignerDsp::runTasks (bool parallel, int numTasks, Task task)
+{
+    if (parallel)
+    {
+        // the denormal flags belong to the thread, the workers need them as well
+        auto taskWithoutDenormals = [&task] (int index)
+        {
+            const juce::ScopedNoDenormals noDenormals;
+            task (index);
+        };
+        const auto numHelped = workers->run (numTasks, taskWithoutDenormals);
+
+        // a second of serial processing when the workers were mostly busy elsewhere
+        ++workerStats.numRuns;
+        workerStats.numHelped += numHelped > 0 ? 1 : 0;
+        if (workerStats.numRuns == WorkerStats::window)
+        {
+            if (workerStats.numHelped < WorkerStats::minHelped)
+                workerStats.backOffSamples = juce::roundToInt (sampleRate);
+            workerStats.numRuns = 0;
+            workerStats.numHelped = 0;
+        }
+        return;
+    }
+
+    for (int i = 0; i < numTasks; ++i)
+        task (i);
+}
+
+template <PolarDesignerDsp::ProximitySide Proximity, bool EqActive>
+void PolarDesignerDsp::processQuantum (const float* front,
+                                       const float* back,
+                                       float* output,
+                                       float* secondOutput,
+                                       float* monitorOutput,
+                                       int offset,
+                                       int numSamples,
+                                       const BlockSettings& block)
+{
+    using namespace juce;
+
+    jassert (numSamples <= processingQuantum);
+
+    const auto n = static_cast<size_t> (numSamples);
+
+    // calculate omni and fig-of-eight parts, together with the proximity compensation
+    float* writePointerOmni = omniEightBuffer.getWritePointer (0);
+    float* writePointerEight = omniEightBuffer.getWritePointer (1);
+
+    if constexpr (Proximity == ProximitySide::none)
+        mixKernels.matrix (front, back, writePointerOmni, writePointerEight, n);
+    else
+        matrixWithFirstOrderFilter<Proximity == ProximitySide::eight> (front,
+                                                                       back,
+                                                                       writePointerOmni,
+                                                                       writePointerEight,
+                                                                       n,
+                                                                       proxCompCoefficients.data(),
+                                                                       proxCompState);
+
+    BandSignals bands;
+    for (unsigned int i = 0; i < MAX_NUM_BANDS; ++i)
+    {
+        bands.omni[i] = filterBankBuffer.getWritePointer (2 * static_cast<int> (i));
+        bands.eight[i] = filterBankBuffer.getWritePointer (2 * static_cast<int> (i) + 1);
+    }
+
+    // the monitor skips everything with latency, so it is mixed before the EQ. Its bands are
+    // done with before the band tasks below write into the filter bank buffer.
+    const auto multiband = block.nActiveBands > 1;
+    if (monitorOutput != nullptr && ! parameters.zeroLatency)
+    {
+        BandSignals monitorBands = bands;
+        if (block.monitorCrossovers)
+        {
+            crossoverFilterBank.process (0, writePointerOmni, monitorBands.omni.data(), n);
+            crossoverFilterBank.process (1, writePointerEight, monitorBands.eight.data(), n);
+            crossoverFilterBank.snapToZero();
+        }
+        else
+        {
+            monitorBands.omni[0] = writePointerOmni;
+            monitorBands.eight[0] = writePointerEight;
+        }
+
+        createPolarPatterns (
+            monitorBands, monitorOutput, offset, numSamples, block, getOutputPattern (0));
+    }
+
+    // EQ processing, omni and eight are independent
+    if constexpr (EqActive)
+    {
+        const auto equalise = [&] (int side)
+        {
+            if (side == 0)
+                eqOmniConv.process (writePointerOmni, &writePointerOmni, n);
+            else
+                eqEightConv.process (writePointerEight, &writePointerEight, n);
+        };
+        runTasks (block.parallelEq, 2, equalise);
+    }
+
+    // filter bank and pattern mix, the mixer is fed while waiting for kernels, so it starts
+    // with history. The band signals of the tracking convolvers and the crossovers go straight
+    // into the filter bank buffer.
+    const auto mixedByBandMixer = multiband && block.runFilterBank;
+    const auto runBandTask = [&] (int index)
+    {
+        switch (block.bandTasks[static_cast<size_t> (index)])
+        {
+            case BandTask::mixer:
+                bandMixer.process (writePointerOmni,
+                                   writePointerEight,
+                                   { mixedByBandMixer ? output : nullptr,
+                                     mixedByBandMixer ? secondOutput : nullptr },
+                                   n);
+                break;
+            case BandTask::omniFilterBank:
+                omniFilterBank.process (writePointerOmni, bands.omni.data(), n);
+                break;
+            case BandTask::eightFilterBank:
+                eightFilterBank.process (writePointerEight, bands.eight.data(), n);
+                break;
+            case BandTask::omniCrossovers:
+                crossoverFilterBank.process (0, writePointerOmni, bands.omni.data(), n);
+                break;
+            case BandTask::eightCrossovers:
+                crossoverFilterBank.process (1, writePointerEight, bands.eight.data(), n);
+                break;
+        }
+    };
+    runTasks (block.parallelBands, block.numBandTasks, runBandTask);
+
+    if (block.runCrossovers)
+        crossoverFilterBank.snapToZero();
+
+    // a single band is mixed straight from the omni and eight signals
+    if (! multiband)
+    {
+        bands.omni[0] = writePointerOmni;
+        bands.eight[0] = writePointerEight;
+    }
+
+    if (trackingActive && block.filterBankReady)
+        trackSignalEnergy (bands, numSamples);
+
+    if (! mixedByBandMixer)
+    {
+        createPolarPatterns (bands, output, offset, numSamples, block, getOutputPattern (0));
+        if (secondOutput != nullptr)
+            createPolarPatterns (
+                bands, secondOutput, offset, numSamples, block, getOutputPattern (1));
+    }
+
+    // delay needs to be running constantly to prevent clicks
+    writeDelayLine (delayLine, output, numSamples);
+    if (secondOutput != nullptr)
+        writeDelayLine (secondDelayLine, secondOutput, numSamples);
+    delayWritePosition = (delayWritePosition + n) % delayLine.size();
+
+    if (! multiband && ! parameters.zeroLatency)
+    {
+        readDelayLine (delayLine, output, numSamples);
+        if (secondOutput != nullptr)
+            readDelayLine (secondDelayLine, secondOutput, numSamples);
+    }
+
+    // the main output has no latency in this mode, the monitor is the same
+    if (monitorOutput != nullptr && parameters.zeroLatency)
+        std::copy_n (output, n, monitorOutput);
+}
+
+PolarDesignerDsp::QuantumProcessor
+    PolarDesignerDsp::getQuantumProcessor (ProximitySide proximity, bool eqActive)
+{
+    using P = ProximitySide;
+    static constexpr QuantumProcessor processors[3][2] = {
+        { &PolarDesignerDsp::processQuantum<P::none, false>,
+          &PolarDesignerDsp::processQuantum<P::none, true> },
+        { &PolarDesignerDsp::processQuantum<P::omni, false>,
+          &PolarDesignerDsp::processQuantum<P::omni, true> },
+        { &PolarDesignerDsp::processQuantum<P::eight, false>,
+          &PolarDesignerDsp::processQuantum<P::eight, true> },
+    };
+
+    return processors[static_cast<size_t> (proximity)][eqActive ? 1 : 0];
+}
+
+bool PolarDesignerDsp::detectIdle (const float* front,
+                                    const float* back,
+                                    int numSamples,
+                                    const BlockSettings& block)
+{
+    using namespace juce;
+
+    const auto isSilent = [numSamples] (const float* data)
+    {
+        const auto range = FloatVectorOperations::findMinAndMax (data, numSamples);
+        return range.getStart() == 0.0f && range.getEnd() == 0.0f;
+    };
+
+    // tracking averages over all blocks, silent ones included
+    if (trackingActive || ! isSilent (front) || ! isSilent (back))
+    {
+        silentSamples = 0;
+        idle = false;
+        return false;
+    }
+
+    // the proximity filter rings until its state is flushed to zero
+    if (! exactlyEqual (proxCompState, 0.0f))
+        return false;
+
+    // once the input has been silent for longer than the impulse response of the chain,
+    // the output is silent as well and nothing has to be computed until the input returns
+    auto tailLength = firLen + (block.eqActive ? eqLength : 0);
+    if (block.runCrossovers || block.monitorCrossovers)
+        tailLength = jmax (tailLength, crossoverFilterBank.getTailLength());
+    if (silentSamples < tailLength)
+    {
+        silentSamples = jmin (tailLength, silentSamples + numSamples);
+        return false;
+    }
+
+    // the convolution histories only hold the drained tail, starting over from silence is
+    // the same as running on, so the first non-silent block continues seamlessly
+    if (! idle)
+    {
+        eqOmniConv.reset();
+        eqEightConv.reset();
+        bandMixer.reset();
+        omniFilterBank.reset();
+        eightFilterBank.reset();
+        crossoverFilterBank.reset();
+        std::fill (delayLine.begin(), delayLine.end(), 0.0f);
+        std::fill (secondDelayLine.begin(), secondDelayLine.end(), 0.0f);
+        idle = true;
+    }
+
+    return true;
+}
+
+bool PolarDesignerDsp::isBandAudible (unsigned int band) const
+{
+    return ! ((parameters.mute[band] && ! parameters.solo[band])
+              || (soloActive && ! parameters.solo[band]));
+}
+
+int PolarDesignerDsp::getLatencySamples (const Parameters& params) const
+{
+    if (params.zeroLatency)
+        return 0;
+
+    auto latency = (getFilterBankLength (sampleRate, params.quality) - 1) / 2;
+
+    // we are using free/diffuse field eq
+    if (params.eqMode != 0)
+        latency += eqLatency;
+
+    return latency;
+}
+
+int PolarDesignerDsp::getFilterBankLength (double sampleRate, FilterBankQuality quality)
+{
+    const auto nativeLength =
+        FILTER_BANK_IR_LENGTHS_AT_NATIVE_SAMPLE_RATE[static_cast<size_t> (quality)];
+    int length = static_cast<int> (std::ceil (static_cast<double> (nativeLength)
+                                              / FILTER_BANK_NATIVE_SAMPLE_RATE * sampleRate));
+    if (length % 2 == 0)
+        length++;
+    jassert (length % 2 == 1);
+    return length;
+}
+
+void PolarDesignerDsp::updateFirLen()
+{
+    firLen = getFilterBankLength (sampleRate, parameters.quality);
+    delayLength = (firLen - 1) / 2;
+}
+
+bool PolarDesignerDsp::requestFilterBank (const Parameters& params, bool queued)
+{
+    // the single band path does not use the filter bank
+    if (params.numBands < 2 || partitionSize == 0)
+        return true;
+
+    FilterBankKey key;
+    key.sampleRate = sampleRate;
+    key.firLen = getFilterBankLength (sampleRate, params.quality);
+    key.partitionSize = partitionSize;
+    key.numBands = params.numBands;
+    for (unsigned int i = 0; i < params.numBands - 1; ++i)
+        key.xOverHz[i] = params.xOverHz[i];
+
+    return request (key, requestedFilterBankKey, queued);
+}
+
+bool PolarDesignerDsp::requestEq (const Parameters& params, bool queued)
+{
+    if ((params.eqMode != 1 && params.eqMode != 2) || partitionSize == 0)
+        return true;
+
+    return request ({ sampleRate, params.eqMode, partitionSize }, requestedEqKey, queued);
+}
+
+template <typename Key>
+bool PolarDesignerDsp::request (const Key& key, Key& requestedKey, bool queued)
+{
+    if (key == requestedKey)
+        return true;
+
+    if (! queued)
+        kernelRequests.request (key);
+    else if (! kernelRequests.queue (key))
+        return false;
+
+    requestedKey = key;
+    return true;
+}
+
+void PolarDesignerDsp::applyPendingKernels (bool waitUntilReady)
+{
+    // the store holds on to everything picked up here until nobody uses it anymore, so the
+    // kernels replaced here or in the convolvers are never freed on the audio thread
+    if (auto kernels = kernelRequests.takeFilterBank (waitUntilReady))
+    {
+        filterBankKernels = std::move (kernels);
+        bandMixer.setBands (filterBankKernels->partitioned);
+        omniFilterBank.setKernel (filterBankKernels->partitioned);
+        eightFilterBank.setKernel (filterBankKernels->partitioned);
+    }
+
+    if (auto kernels = kernelRequests.takeEq (waitUntilReady))
+    {
+        eqKernels = std::move (kernels);
+        eqOmniConv.setKernel (eqKernels->omni);
+        eqEightConv.setKernel (eqKernels->eight);
+    }
+}
+
+std::array<float, 3> PolarDesignerDsp::designProxCompCoefficients (float distance,
+                                                                  double sampleRate)
+{
+    // unity gain filter
+    float b0 = 1.0f, b1 = 0.0f, a0 = 1.0f, a1 = 0.0f;
+
+    if (std::abs (distance) >= 0.0001f)
+    {
+        auto c = 343.0f;
+        double fs = sampleRate;
+
+        float a = (0.05f - 1.0f) / (-log (1.1f) + log (0.1f));
+        float b = 1.0f + a * log (0.1f);
+        float r = -a * log (std::max (std::abs (distance), 0.0001f)) + b;
+
+        if (distance <= 0)
+        { // Bass cut
+            r = std::max (r, 0.01f);
+            b0 = static_cast<float> (c * (r - 1.0f) / (fs * 2.0f * r) + 1.0f);
+            b1 = static_cast<float> (-exp (-c / (fs * r))
+                                     * (1.0f - c * (r - 1.0f) / (fs * 2.0f * r)));
+            a1 = static_cast<float> (-exp (-c / (fs * r)));
+        }
+        else
+        { // Bass boost
+            r = std::max (r, 0.05f);
+            b0 = static_cast<float> (c * (1.0f - r) / (fs * 2.0f * r) + 1.0f);
+            b1 = static_cast<float> (-exp (-c / fs) * (1.0f - c * (1.0f - r) / (fs * 2.0f * r)));
+            a1 = static_cast<float> (-exp (-c / fs));
+        }
+    }
+
+    return { b0 / a0, b1 / a0, a1 / a0 };
+}
+
+void PolarDesignerDsp::setProxCompCoefficients (float distance)
+{
+    proxCompDistance = distance;
+    proxCompCoefficients = designProxCompCoefficients (distance, sampleRate);
+}
+
+void PolarDesignerDsp::createPolarPatterns (const BandSignals& bands,
+                                            float* output,
+                                            int offset,
+                                            int numSamples,
+                                            const BlockSettings& block,
+                                            const OutputPattern& pattern)
+{
+    // position of this quantum within the ramps of the host block
+    const auto rampStart = static_cast<float> (offset) / static_cast<float> (block.length);
+    const auto rampEnd =
+        static_cast<float> (offset + numSamples) / static_cast<float> (block.length);
+    const auto rampScale = 1.0f / static_cast<float> (numSamples);
+
+    // the ramps of all audible bands are mixed in one pass, to prevent crackling noises
+    BandMix mix;
+    for (unsigned int b = 0; b < block.numAudibleBands; ++b)
+    {
+        const auto i = block.audibleBands[b];
+        const auto [oldOmni, oldEight] =
+            getPatternGains (pattern.oldDirFactors[i], pattern.oldGainsDb[i]);
+        const auto [newOmni, newEight] =
+            getPatternGains (pattern.dirFactors[i], pattern.gainsDb[i]);
+
+        mix.omni[b] = bands.omni[i];
+        mix.eight[b] = bands.eight[i];
+        mix.omniStart[b] = oldOmni + rampStart * (newOmni - oldOmni);
+        mix.omniStep[b] = (rampEnd - rampStart) * (newOmni - oldOmni) * rampScale;
+        mix.eightStart[b] = oldEight + rampStart * (newEight - oldEight);
+        mix.eightStep[b] = (rampEnd - rampStart) * (newEight - oldEight) * rampScale;
+    }
+
+    mix.numBands = block.numAudibleBands;
+    block.rampedMix (mix, output, static_cast<size_t> (numSamples));
+}
+
+void PolarDesignerDsp::updateBandMixer (const BlockSettings& block)
+{
+    // muted bands have no weight, the ramps span the whole host block
+    for (int o = 0; o < (block.secondOutput ? 2 : 1); ++o)
+    {
+        const auto pattern = getOutputPattern (o);
+        MixingConvolver::Weights start, end;
+        for (unsigned int b = 0; b < block.numAudibleBands; ++b)
+        {
+            const auto i = block.audibleBands[b];
+            std::tie (start.omni[i], start.eight[i]) =
+                getPatternGains (pattern.oldDirFactors[i], pattern.oldGainsDb[i]);
+            std::tie (end.omni[i], end.eight[i]) =
+                getPatternGains (pattern.dirFactors[i], pattern.gainsDb[i]);
+        }
+
+        bandMixer.setWeights (start, end, block.length, o);
+    }
+}
+
+std::pair<float, float> PolarDesignerDsp::getPatternGains (float dirFactor, float gainDb)
+{
+    const auto gain = juce::Decibels::decibelsToGain (gainDb, -59.91f);
+    return { (1 - std::abs (dirFactor)) * gain, dirFactor * gain };
+}
+
+void PolarDesignerDsp::writeDelayLine (std::span<float> line,
+                                       const float* input,
+                                       int numSamples) const
+{
+    // all delay lines share the write position, it is advanced once they are written
+    const auto size = line.size();
+    const auto n = static_cast<size_t> (numSamples);
+    const auto first = std::min (n, size - delayWritePosition);
+
+    std::copy_n (input, first, line.data() + delayWritePosition);
+    std::copy_n (input + first, n - first, line.data());
+}
+
+void PolarDesignerDsp::readDelayLine (std::span<const float> line,
+                                      float* output,
+                                      int numSamples) const
+{
+    // the samples written last end at delayWritePosition
+    const auto size = line.size();
+    const auto n = static_cast<size_t> (numSamples);
+    const auto readPosition =
+        (delayWritePosition + 2 * size - n - static_cast<size_t> (delayLength)) % size;
+    const auto first = std::min (n, size - readPosition);
+
+    std::copy_n (line.data() + readPosition, first, output);
+    std::copy_n (line.data(), n - first, output + first);
+}
+
+//==============================================================================
+double PolarDesignerDsp::BandEnergies::getPower (size_t band, float alpha) const
+{
+    const auto a = static_cast<double> (alpha);
+    return std::pow ((1 - std::abs (a)), 2.0) * omniSq[band] + std::pow (a, 2.0) * eightSq[band]
+           + 2 * (1 - std::abs (a)) * a * omniEight[band];
+}
+
+bool PolarDesignerDsp::BandEnergies::isEmpty (size_t band) const
+{
+    return juce::approximatelyEqual (omniSq[band], 0.0)
+           && juce::approximatelyEqual (eightSq[band], 0.0)
+           && juce::approximatelyEqual (omniEight[band], 0.0);
+}
+
+void PolarDesignerDsp::startTracking (bool trackDisturber)
+{
+    trackingDisturber = trackDisturber;
+    (trackDisturber ? disturberEnergies : signalEnergies) = {};
+    nrBlocksRecorded = 0;
+    trackingActive = true;
+}
+
+bool PolarDesignerDsp::stopTracking()
+{
+    trackingActive = false;
+    if (nrBlocksRecorded == 0)
+        return false;
+
+    const auto n = static_cast<double> (nrBlocksRecorded);
+    auto& energies = trackingDisturber ? disturberEnergies : signalEnergies;
+
+    for (size_t i = 0; i < MAX_NUM_BANDS; ++i)
+    {
+        energies.omniSq[i] /= n;
+        energies.eightSq[i] /= n;
+        energies.omniEight[i] /= n;
+    }
+
+    return true;
+}
+
+void PolarDesignerDsp::resetTracking()
+{
+    trackingActive = false;
+    trackingDisturber = false;
+    nrBlocksRecorded = 0;
+    signalEnergies = {};
+    disturberEnergies = {};
+}
+
+void PolarDesignerDsp::trackSignalEnergy (const BandSignals& bands, int numSamples)
+{
+    if (numSamples == 0)
+        return; // avoid division by zero
+
+    auto& energies = trackingDisturber ? disturberEnergies : signalEnergies;
+    const auto scale = 1.0 / static_cast<double> (numSamples);
+
+    // summed in double precision, recordings run over millions of samples
+    for (unsigned int i = 0; i < parameters.numBands; ++i)
+    {
+        const float* readPointerOmni = bands.omni[i];
+        const float* readPointerEight = bands.eight[i];
+
+        double omniSq = 0.0, eightSq = 0.0, omniEight = 0.0;
+        for (int j = 0; j < numSamples; ++j)
+        {
+            const auto omniSample = static_cast<double> (readPointerOmni[j]);
+            const auto eightSample = static_cast<double> (readPointerEight[j]);
+            omniSq += omniSample * omniSample;
+            eightSq += eightSample * eightSample;
+            omniEight += omniSample * eightSample;
+        }
+
+        energies.omniSq[i] += omniSq * scale;
+        energies.eightSq[i] += eightSq * scale;
+        energies.omniEight[i] += omniEight * scale;
+    }
+    ++nrBlocksRecorded;
+}
+
+// !J! NOTE: allowBackwardsPattern is ALWAYS true, so all searches start at -0.5
+PolarDesignerDsp::Pattern PolarDesignerDsp::getMinimumDisturbancePattern (
+    unsigned int numBands) const
+{
+    Pattern pattern;
+    const float alphaStart = -0.5f;
+
+    for (unsigned int i = 0; i < numBands; ++i)
+    {
+        double disturberPower = 0.0;
+        float minPowerAlpha = 0.0f;
+
+        for (float alpha = alphaStart; alpha <= 1.0f; alpha += 0.01f)
+        {
+            const auto currentPower = disturberEnergies.getPower (i, alpha);
+            if (juce::exactlyEqual (alpha, alphaStart) || (currentPower < disturberPower))
+            {
+                disturberPower = currentPower;
+                minPowerAlpha = alpha;
+            }
+        }
+
+        // do not apply changes, if playback is not active
+        if (! juce::exactlyEqual (disturberPower, 0.0))
+            pattern[i] = minPowerAlpha;
+    }
+
+    return pattern;
+}
+
+PolarDesignerDsp::Pattern PolarDesignerDsp::getMaximumSignalPattern (unsigned int numBands) const
+{
+    Pattern pattern;
+    const float alphaStart = -0.5f;
+
+    for (unsigned int i = 0; i < numBands; ++i)
+    {
+        double signalPower = 0.0;
+        float maxPowerAlpha = 0.0f;
+
+        for (float alpha = alphaStart; alpha <= 1.0f; alpha += 0.01f)
+        {
+            const auto currentPower = signalEnergies.getPower (i, alpha);
+            if (juce::exactlyEqual (alpha, alphaStart) || (currentPower > signalPower))
+            {
+                signalPower = currentPower;
+                maxPowerAlpha = alpha;
+            }
+        }
+
+        if (! juce::exactlyEqual (signalPower, 0.0))
+            pattern[i] = maxPowerAlpha;
+    }
+
+    return pattern;
+}
+
+PolarDesignerDsp::Pattern
+    PolarDesignerDsp::getMaximumSignalToDisturbanceRatioPattern (unsigned int numBands) const
+{
+    Pattern pattern;
+
+    // Skip if any band has neither signal nor disturber recorded
+    for (unsigned int i = 0; i < numBands; ++i)
+        if (signalEnergies.isEmpty (i) && disturberEnergies.isEmpty (i))
+            return pattern;
+
+    const float alphaStart = -0.5f;
+
+    for (unsigned int i = 0; i < numBands; ++i)
+    {
+        double distToSigRatio = 0.0;
+        float maxDistToSigAlpha = 0.0f;
+
+        for (float alpha = alphaStart; alpha <= 1.0f; alpha += 0.01f)
+        {
+            const auto currentSigPower = signalEnergies.getPower (i, alpha);
+            const auto currentDistPower = disturberEnergies.getPower (i, alpha);
+            const auto currentRatio = juce::exactlyEqual (currentDistPower, 0.0)
+                                          ? 0.0
+                                          : currentSigPower / currentDistPower;
+
+            if (juce::exactlyEqual (alpha, alphaStart) || (currentRatio > distToSigRatio))
+            {
+                distToSigRatio = currentRatio;
+                maxDistToSigAlpha = alpha;
+            }
+        }
+
+        if (! juce::exactlyEqual (distToSigRatio, 0.0))
+            pattern[i] = maxDistToSigAlpha;
+    }
+
+    return pattern;
+}
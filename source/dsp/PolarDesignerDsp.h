@@ -0,0 +1,386 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "BandLayouts.hpp"
+#include "Constants.hpp"
+#include "CrossoverFilterBank.hpp"
+#include "KernelStore.hpp"
+#include "MixKernels.hpp"
+#include "MixingConvolver.hpp"
+#include "PartitionedConvolver.hpp"
+#include "ScratchArena.hpp"
+#include "WorkerPool.hpp"
+
+#include <array>
+#include <juce_dsp/juce_dsp.h>
+#include <optional>
+
+/* The PolarDesigner signal chain without any plugin or GUI dependencies: front/back matrixing,
+ * proximity compensation, free/diffuse field EQ, filter bank, pattern mix and the delay of the
+ * single band path. The zero latency mode splits the bands with minimum phase crossovers
+ * instead and skips the EQ and proximity compensation. The plugin wraps this, tools and
+ * benchmarks can use it on their own.
+ *
+ * prepare(), reset() and requestKernels() may be called while the audio thread is not running,
+ * everything else belongs to the audio thread.
+ */
+class PolarDesignerDsp
+{
+public:
+    struct Parameters
+    {
+        unsigned int numBands = MAX_NUM_EQS;
+        std::array<float, MAX_NUM_BANDS - 1> xOverHz = getBandLayout (MAX_NUM_EQS).initXOverHz;
+        std::array<float, MAX_NUM_BANDS> dirFactors {}; // 0 = omni, 0.5 = cardioid, 1 = eight
+        std::array<float, MAX_NUM_BANDS> gainsDb {};
+        std::array<bool, MAX_NUM_BANDS> solo {};
+        std::array<bool, MAX_NUM_BANDS> mute {};
+        int eqMode = 0; // 0 = off, 1 = free field, 2 = diffuse field
+        float proximity = 0.0f; // 0 = no proximity compensation
+        bool zeroLatency = false;
+        FilterBankQuality quality = FilterBankQuality::standard;
+
+        // a second virtual microphone from the same filter bank, solo and mute apply to both
+        bool secondOutput = false;
+        std::array<float, MAX_NUM_BANDS> secondDirFactors {};
+        std::array<float, MAX_NUM_BANDS> secondGainsDb {};
+
+        // the main pattern without latency, for cue mixes while recording the main output
+        bool monitorOutput = false;
+    };
+
+    // optimal dirFactor per band, empty where the recording did not allow a decision
+    using Pattern = std::array<std::optional<float>, MAX_NUM_BANDS>;
+
+    PolarDesignerDsp() = default;
+
+    void prepare (double sampleRate, int maximumBlockSize);
+    bool isPrepared() const { return partitionSize > 0; }
+
+    // upper limit for the internal sub-block length, takes effect with the next prepare()
+    void setProcessingQuantum (int maxQuantum);
+    int getProcessingQuantum() const { return processingQuantum; }
+
+    // keeps the scratch memory in RAM (mlock), takes effect with the next prepare()
+    void setLockScratchMemory (bool shouldLock) { lockScratchMemory = shouldLock; }
+    bool isScratchMemoryLocked() const { return scratch.isLocked(); }
+    size_t getScratchMemorySize() const { return scratch.getSize(); }
+
+    // clears the filter and delay states, the gain ramps are kept
+    void reset();
+    void resetGainRamps();
+
+    void setParameters (const Parameters& newParameters);
+    const Parameters& getParameters() const { return parameters; }
+
+    // starts designing the kernels for the given settings in the background
+    void requestKernels (const Parameters& params);
+
+    /* Runs the independent convolutions of large quanta on worker threads as well, takes effect
+     * with the next prepare(). Small quanta are always processed on the calling thread.
+     */
+    void setParallelProcessing (bool shouldUseWorkers) { useWorkers = shouldUseWorkers; }
+
+    /* Shares the workers of the process wide pool with all other instances instead of running
+     * its own, for hosts calling many instances from one thread. Takes effect with the next
+     * prepare().
+     */
+    void setSharedWorkers (bool shouldShare) { useSharedWorkers = shouldShare; }
+    int getNumWorkers() const { return workers != nullptr ? workers->getNumWorkers() : 0; }
+
+    // offline renders wait for kernels to be designed instead of running the single band path
+    void setNonRealtime (bool isNonRealtime) { waitForKernels = isNonRealtime; }
+
+    // front and back in, virtual microphone out. output may point to the front channel.
+    // numSamples may exceed the prepared block size, nothing is allocated in here
+    void process (const float* front, const float* back, float* output, int numSamples)
+    {
+        process (front, back, output, nullptr, nullptr, numSamples);
+    }
+
+    /* Same with the second pattern, which costs one more mixing pass instead of a second filter
+     * bank, and the monitor. The monitor plays the main pattern without latency: the bands are
+     * split by the zero latency crossovers and the EQ is left out. Either of secondOutput and
+     * monitorOutput may point to the back channel, both are cleared while switched off.
+     */
+    void process (const float* front,
+                  const float* back,
+                  float* output,
+                  float* secondOutput,
+                  float* monitorOutput,
+                  int numSamples);
+
+    int getLatencySamples (const Parameters& params) const;
+
+    // true while the input has been silent for longer than the tail, nothing is computed then
+    bool isIdle() const { return idle; }
+
+    // true while all filter and delay states are silent, i.e. when idle or nothing has been
+    // processed since prepare() or reset(). A new prepare() continues seamlessly then.
+    bool isAtRest() const { return idle || ! hasProcessed; }
+    double getSampleRate() const { return sampleRate; }
+    size_t getPartitionSize() const { return partitionSize; }
+    FftBackendType getFftBackendType() const { return omniFilterBank.getFftBackendType(); }
+
+    // odd length of the linear phase filter bank FIRs at the given sample rate
+    static int getFilterBankLength (double sampleRate,
+                                    FilterBankQuality quality = FilterBankQuality::standard);
+
+    // normalised first order proximity compensation filter { b0, b1, a1 }
+    static std::array<float, 3> designProxCompCoefficients (float distance, double sampleRate);
+
+    //==============================================================================
+    // energy tracking of the filter bank outputs, used to find optimal patterns
+    void startTracking (bool trackDisturber);
+    bool stopTracking(); // false if nothing was recorded
+    void resetTracking();
+    bool isTracking() const { return trackingActive; }
+    bool isTrackingDisturber() const { return trackingDisturber; }
+
+    Pattern getMinimumDisturbancePattern (unsigned int numBands) const;
+    Pattern getMaximumSignalPattern (unsigned int numBands) const;
+    Pattern getMaximumSignalToDisturbanceRatioPattern (unsigned int numBands) const;
+
+private:
+    struct BandEnergies
+    {
+        std::array<double, MAX_NUM_BANDS> omniSq {}, eightSq {}, omniEight {};
+
+        double getPower (size_t band, float alpha) const;
+        bool isEmpty (size_t band) const;
+    };
+
+    Parameters parameters;
+    bool soloActive = false;
+    bool waitForKernels = false;
+
+    double sampleRate = FILTER_BANK_NATIVE_SAMPLE_RATE;
+    int maxBlockSize = 0;
+    int maxProcessingQuantum = PD_DEFAULT_PROCESSING_QUANTUM;
+    int processingQuantum = 0; // length of the internal buffers
+
+    // use odd FIR_LEN for even filter order (FIR_LEN = N+1)
+    // (lowpass and highpass need even filter order to put a zero at f=0 and f=pi)
+    int firLen = FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE;
+    int maxFirLen = FILTER_BANK_IR_LENGTH_AT_NATIVE_SAMPLE_RATE; // all buffers fit every quality
+    int eqLatency = 0;
+    int eqLength = 0;
+    size_t partitionSize = 0;
+
+    // buffers and convolver state of this instance, allocated in prepare()
+    ScratchArena scratch;
+    bool lockScratchMemory = false;
+
+    // filter kernels shared between all instances
+    juce::SharedResourcePointer<KernelStore> kernelStore;
+    std::shared_ptr<const FilterBankKernels> filterBankKernels;
+    std::shared_ptr<const EqKernels> eqKernels;
+    bool filterBankOutdated = true, eqOutdated = true;
+
+    // kernels are designed in the background and picked up by process() once ready
+    KernelRequests kernelRequests { *kernelStore };
+    FilterBankKey requestedFilterBankKey;
+    EqKey requestedEqKey;
+
+    // free field / diffuse field eq
+    PartitionedConvolver eqOmniConv;
+    PartitionedConvolver eqEightConv;
+    bool eqWasActive = false;
+
+    // proximity compensation filter, first order { b0, b1, a1 }
+    std::array<float, 3> proxCompCoefficients { 1.0f, 0.0f, 0.0f };
+    float proxCompState = 0.0f;
+    float proxCompDistance = 0.0f;
+
+    // delay (in case of 1 active band), ring buffer in the scratch arena
+    std::span<float> delayLine, secondDelayLine;
+    size_t delayWritePosition = 0;
+    int delayLength = 0;
+
+    // both refer to the scratch arena
+    juce::AudioBuffer<float> omniEightBuffer; // holds omni and fig-of-eight signals, size: 2
+    juce::AudioBuffer<float> filterBankBuffer; // holds filtered data, size: N_CH_IN*MAX_NUM_BANDS
+
+    // filter bank and pattern mix of all bands, the cost does not depend on the band count
+    MixingConvolver bandMixer;
+
+    // the separate band signals are only needed to track their energies
+    PartitionedConvolver omniFilterBank; // omni signal -> one output per band
+    PartitionedConvolver eightFilterBank; // fig-of-eight signal -> one output per band
+    bool trackingBands = false;
+
+    // zero latency filter bank, writes into the filter bank buffer. Splits the bands of the
+    // monitor while the main output runs the linear phase filter bank.
+    CrossoverFilterBank crossoverFilterBank;
+    bool crossoversWereActive = false;
+
+    std::array<float, MAX_NUM_BANDS> oldDirFactors {};
+    std::array<float, MAX_NUM_BANDS> oldBandGains {};
+    std::array<float, MAX_NUM_BANDS> oldSecondDirFactors {};
+    std::array<float, MAX_NUM_BANDS> oldSecondBandGains {};
+    bool secondOutputWasActive = false;
+
+    // the weights of one output and where their ramps start
+    struct OutputPattern
+    {
+        const std::array<float, MAX_NUM_BANDS>& dirFactors;
+        const std::array<float, MAX_NUM_BANDS>& gainsDb;
+        std::array<float, MAX_NUM_BANDS>& oldDirFactors;
+        std::array<float, MAX_NUM_BANDS>& oldGainsDb;
+    };
+
+    const MixKernels& mixKernels = getMixKernels();
+
+    // the EQ convolvers and the filter bank stage are split between the caller and the workers
+    // of either pool
+    WorkerPool workerPool;
+    std::optional<juce::SharedResourcePointer<SharedWorkerPool>> sharedWorkerPool;
+    WorkerPool* workers = nullptr;
+    bool useWorkers = false, useSharedWorkers = false;
+
+    /* The workers may be busy with other instances or other plugins. When they rarely get to
+     * help, the stages stay on the calling thread for a while, which saves the wake-ups.
+     */
+    struct WorkerStats
+    {
+        static constexpr int window = 32; // parallel runs per evaluation
+        static constexpr int minHelped = 8; // runs the workers took part in
+
+        int numRuns = 0, numHelped = 0;
+        int backOffSamples = 0;
+    } workerStats;
+
+    // per band omni and eight signals of the current quantum
+    struct BandSignals
+    {
+        std::array<float*, MAX_NUM_BANDS> omni, eight;
+    };
+
+    // which signal the proximity compensation filters
+    enum class ProximitySide
+    {
+        none,
+        omni,
+        eight
+    };
+
+    // independent parts of the filter bank stage, each runs on one thread
+    enum class BandTask
+    {
+        mixer,
+        omniFilterBank,
+        eightFilterBank,
+        omniCrossovers,
+        eightCrossovers
+    };
+
+    struct BlockSettings;
+    using QuantumProcessor = void (PolarDesignerDsp::*) (const float* front,
+                                                         const float* back,
+                                                         float* output,
+                                                         float* secondOutput,
+                                                         float* monitorOutput,
+                                                         int offset,
+                                                         int numSamples,
+                                                         const BlockSettings& block);
+
+    // settings that stay fixed for all quanta of one host block, resolved once per block
+    struct BlockSettings
+    {
+        bool eqActive = false;
+        bool runFilterBank = false; // the convolvers are fed while waiting for kernels
+        bool runCrossovers = false; // zero latency bands
+        bool monitorCrossovers = false; // zero latency bands of the monitor only
+        bool filterBankReady = false;
+        bool trackBands = false;
+        bool secondOutput = false;
+        bool monitorOutput = false;
+        ProximitySide proximity = ProximitySide::none;
+        unsigned int nActiveBands = 1;
+        int length = 0; // the gain ramps span the whole host block
+
+        // bands that contribute to the mix, the mix kernel is specialised for their number
+        std::array<unsigned int, MAX_NUM_BANDS> audibleBands {};
+        unsigned int numAudibleBands = 0;
+        RampedMixFn rampedMix = nullptr;
+        QuantumProcessor processQuantum = nullptr;
+
+        std::array<BandTask, 3> bandTasks {};
+        int numBandTasks = 0;
+        bool parallelEq = false;
+        bool parallelBands = false;
+    };
+
+    // samples of digital silence at the input, up to the length of the tail
+    int silentSamples = 0;
+    bool idle = false;
+    bool hasProcessed = false;
+
+    bool trackingActive = false;
+    bool trackingDisturber = false;
+    int nrBlocksRecorded = 0;
+    BandEnergies signalEnergies, disturberEnergies;
+
+    void updateFirLen();
+    bool requestFilterBank (const Parameters& params, bool queued);
+    bool requestEq (const Parameters& params, bool queued);
+    template <typename Key>
+    bool request (const Key& key, Key& requestedKey, bool queued);
+    void applyPendingKernels (bool waitUntilReady);
+    void setProxCompCoefficients (float distance);
+    bool isBandAudible (unsigned int band) const;
+    void updateBandMixer (const BlockSettings& block);
+    bool detectIdle (const float* front,
+                      const float* back,
+                      int numSamples,
+                      const BlockSettings& block);
+    OutputPattern getOutputPattern (int outputIndex);
+    void commitGainRamps (const BlockSettings& block);
+    void planTasks (BlockSettings& block) const;
+    static float getConvolutionCost (size_t partitionSize, int irLength, int numOutputs);
+    template <typename Task>
+    void runTasks (bool parallel, int numTasks, Task task);
+    template <ProximitySide Proximity, bool EqActive>
+    void processQuantum (const float* front,
+                         const float* back,
+                         float* output,
+                         float* secondOutput,
+                         float* monitorOutput,
+                         int offset,
+                         int numSamples,
+                         const BlockSettings& block);
+    static QuantumProcessor getQuantumProcessor (ProximitySide proximity, bool eqActive);
+    void trackSignalEnergy (const BandSignals& bands, int numSamples);
+    void createPolarPatterns (const BandSignals& bands,
+                              float* output,
+                              int offset,
+                              int numSamples,
+                              const BlockSettings& block,
+                              const OutputPattern& pattern);
+    static std::pair<float, float> getPatternGains (float dirFactor, float gainDb);
+    void writeDelayLine (std::span<float> line, const float* input, int numSamples) const;
+    void readDelayLine (std::span<const float> line, float* output, int numSamples) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolarDesignerDsp)
+};
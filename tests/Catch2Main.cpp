@@ -1,6 +1,7 @@
 // All test files are included in the executable via the Glob in CMakeLists.txt
 
 #include "juce_gui_basics/juce_gui_basics.h"
+#include <FftBackend.hpp>
 #include <catch2/catch_session.hpp>
 
 int main (int argc, char* argv[])
@@ -11,6 +12,11 @@ int main (int argc, char* argv[])
     // It's nicer DX when placed here vs. manually in Catch2 SECTIONs
     juce::ScopedJuceInitialiser_GUI gui;
 
+#if JUCE_DSP_USE_STATIC_FFTW
+    // the tests must not rewrite the FFTW wisdom of the installed plugin
+    FftwPlanner::setWisdomFile ({});
+#endif
+
     const int result = Catch::Session().run (argc, argv);
 
     return result;
@@ -0,0 +1,371 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include "helpers/ReferenceEngine.hpp"
+#include "helpers/TestHelpers.hpp"
+
+#include <Conversions.hpp>
+#include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+/* Differential tests: PolarDesignerDsp has to stay within float rounding of the time domain
+ * reference implementation, whatever partitioning, FFT backend or SIMD path it uses. Any
+ * faster engine replacing it has to pass the same tests.
+ */
+
+namespace
+{
+// FFT convolution in float against direct convolution, about -100 dB for full scale signals
+constexpr float maxEngineError = 1.0e-5f;
+
+using Parameters = PolarDesignerDsp::Parameters;
+
+// the engine handles more bands than the plugin exposes, all of them are covered
+Parameters randomKernelSettings (juce::Random& random)
+{
+    Parameters params;
+    params.numBands =
+        static_cast<unsigned int> (random.nextInt ({ 1, static_cast<int> (MAX_NUM_BANDS) + 1 }));
+    params.xOverHz.fill (0.0f);
+
+    const auto& layout = getBandLayout (params.numBands);
+    for (unsigned int i = 0; i < layout.getNumCrossovers(); ++i)
+        params.xOverHz[i] = layout.initXOverHz[i] * (0.8f + 0.4f * random.nextFloat());
+
+    params.eqMode = random.nextInt (3);
+    params.zeroLatency = random.nextInt (5) == 0;
+    params.quality = static_cast<FilterBankQuality> (random.nextInt (NUM_FILTER_BANK_QUALITIES));
+    return params;
+}
+
+// automation of everything that does not need new kernels
+void randomiseMix (Parameters& params, juce::Random& random)
+{
+    for (size_t i = 0; i < MAX_NUM_BANDS; ++i)
+    {
+        params.dirFactors[i] = -0.5f + 1.5f * random.nextFloat();
+        params.gainsDb[i] = -24.0f + 42.0f * random.nextFloat();
+        params.solo[i] = random.nextInt (8) == 0;
+        params.mute[i] = random.nextInt (8) == 0;
+    }
+
+    params.proximity = random.nextInt (3) == 0 ? -1.0f + 2.0f * random.nextFloat() : 0.0f;
+}
+
+float maxAbsDifference (const std::vector<float>& a, const std::vector<float>& b)
+{
+    float maxError = 0.0f;
+    for (size_t i = 0; i < std::min (a.size(), b.size()); ++i)
+        maxError = std::max (maxError, std::abs (a[i] - b[i]));
+    return maxError;
+}
+} // namespace
+
+TEST_CASE ("Engine matches the reference implementation", "[differential]")
+{
+    // fixed seed, so failures can be reproduced
+    juce::Random random (0x5044);
+
+    constexpr double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    constexpr int maxBlockSizes[] = { 64, 256, 480, 1024, 4096 };
+    constexpr int quanta[] = {
+        32, 128, PD_DEFAULT_PROCESSING_QUANTUM, PD_OFFLINE_PROCESSING_QUANTUM
+    };
+    constexpr int numSamples = 8192;
+    constexpr int numRuns = 12;
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        const auto sampleRate = sampleRates[random.nextInt (3)];
+        const auto maxBlockSize = maxBlockSizes[random.nextInt (5)];
+        const auto quantum = quanta[random.nextInt (4)];
+        const auto parallel = random.nextInt (3); // serial, own workers, shared workers
+        auto params = randomKernelSettings (random);
+        randomiseMix (params, random);
+
+        INFO ("run " << run << ": " << sampleRate << " Hz, max block " << maxBlockSize
+                     << ", quantum " << quantum << ", " << params.numBands << " bands, eq "
+                     << params.eqMode << ", quality " << static_cast<int> (params.quality)
+                     << (params.zeroLatency ? ", zero latency" : "")
+                     << (parallel == 1 ? ", own workers" : "")
+                     << (parallel == 2 ? ", shared workers" : ""));
+
+        PolarDesignerDsp engine;
+        engine.setParameters (params);
+        engine.setNonRealtime (true);
+        engine.setProcessingQuantum (quantum);
+        engine.setParallelProcessing (parallel > 0);
+        engine.setSharedWorkers (parallel == 2);
+        engine.prepare (sampleRate, maxBlockSize);
+
+        TestHelpers::ReferenceEngine reference;
+        reference.prepare (sampleRate, params);
+
+        REQUIRE (engine.getLatencySamples (params) == reference.getLatencySamples());
+
+        std::vector<float> front (numSamples), back (numSamples);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            front[static_cast<size_t> (i)] = random.nextFloat() - 0.5f;
+            back[static_cast<size_t> (i)] = 0.5f * (random.nextFloat() - 0.5f);
+        }
+
+        std::vector<float> engineOut (numSamples), referenceOut (numSamples);
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            // hosts may exceed the announced block size, e.g. FL Studio or offline bounces
+            const auto n =
+                std::min (random.nextInt ({ 1, 2 * maxBlockSize + 1 }), numSamples - pos);
+
+            // host automation lands on block boundaries
+            if (random.nextInt (4) == 0)
+            {
+                randomiseMix (params, random);
+                engine.setParameters (params);
+                reference.setParameters (params);
+            }
+
+            const auto offset = static_cast<size_t> (pos);
+            engine.process (front.data() + offset,
+                            back.data() + offset,
+                            engineOut.data() + offset,
+                            n);
+            reference.process (front.data() + offset,
+                               back.data() + offset,
+                               referenceOut.data() + offset,
+                               n);
+            pos += n;
+        }
+
+        const auto maxError = maxAbsDifference (engineOut, referenceOut);
+        CAPTURE (maxError);
+        REQUIRE (maxError < maxEngineError);
+    }
+}
+
+/* The reference has no kernel crossfades, so with changing crossovers the engine is checked for
+ * steps instead: a low sine ramped between two gains moves by about the same amount per sample
+ * whether or not the band kernels fade at the same time.
+ */
+TEST_CASE ("Mix automation stays smooth while the band kernels change", "[differential]")
+{
+    juce::Random random (0x5045);
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numSamples = 48000;
+    constexpr int warmUp = 4096;
+
+    const auto render = [&] (bool changeCrossovers)
+    {
+        Parameters params;
+        params.numBands = 3;
+        params.xOverHz.fill (0.0f);
+        const auto& layout = getBandLayout (params.numBands);
+        for (unsigned int i = 0; i < layout.getNumCrossovers(); ++i)
+            params.xOverHz[i] = layout.initXOverHz[i];
+
+        PolarDesignerDsp engine;
+        engine.setParameters (params);
+        engine.setNonRealtime (true);
+        engine.prepare (sampleRate, blockSize);
+
+        std::vector<float> input (numSamples), silence (numSamples, 0.0f), output (numSamples);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = 0.5f
+                       * std::sin (juce::MathConstants<float>::twoPi * 30.0f
+                                   * static_cast<float> (i) / static_cast<float> (sampleRate));
+
+        // new kernels every few blocks, also while a ramp catches up with the last fade
+        int nextChange = 0;
+        for (int block = 0; block * blockSize < numSamples; ++block)
+        {
+            for (unsigned int i = 0; i < params.numBands; ++i)
+                params.gainsDb[i] = block % 2 == 0 ? 12.0f : -12.0f;
+
+            if (changeCrossovers && block == nextChange)
+            {
+                for (unsigned int i = 0; i < layout.getNumCrossovers(); ++i)
+                    params.xOverHz[i] = layout.initXOverHz[i] * (0.9f + 0.2f * random.nextFloat());
+                nextChange += random.nextInt ({ 1, 9 });
+            }
+
+            engine.setParameters (params);
+
+            const auto offset = static_cast<size_t> (block * blockSize);
+            engine.process (input.data() + offset,
+                            silence.data() + offset,
+                            output.data() + offset,
+                            blockSize);
+        }
+
+        float maxStep = 0.0f;
+        for (size_t i = warmUp; i < output.size(); ++i)
+            maxStep = std::max (maxStep, std::abs (output[i] - output[i - 1]));
+        return maxStep;
+    };
+
+    const auto mixOnly = render (false);
+    const auto withKernelChanges = render (true);
+
+    // an unramped gain change steps by more than a whole ramp moves per sample
+    CAPTURE (mixOnly, withKernelChanges);
+    REQUIRE (mixOnly > 0.0f);
+    REQUIRE (withKernelChanges < 2.0f * mixOnly);
+}
+
+/* The filter bank references in tests/data were rendered by the plugin, the reference
+ * implementation has to reconstruct them from the same settings.
+ */
+TEST_CASE ("Reference implementation reproduces the filter bank references", "[differential]")
+{
+    using namespace TestHelpers;
+
+    constexpr auto sampleRate = 48000.0;
+    constexpr auto bufferSize = 1024;
+
+    PolarDesignerAudioProcessor proc;
+    auto& vts = proc.getValueTreeState();
+    juce::File referenceFile;
+
+    // same parameter calls as the "Crossover update" test that rendered the references
+    SECTION ("2 bands")
+    {
+        vts.getParameter ("nrBands")->setValueNotifyingHost (2.0f);
+        vts.getParameter ("xOverF1")->setValueNotifyingHost (200.0f);
+        referenceFile = getTestDataPath().getChildFile ("Filterbank_2-band-200Hz.wav");
+    }
+
+    SECTION ("5 bands")
+    {
+        vts.getParameter ("nrBands")->setValueNotifyingHost (5.0f);
+        vts.getParameter ("xOverF1")->setValueNotifyingHost (200.0f);
+        vts.getParameter ("xOverF2")->setValueNotifyingHost (600.0f);
+        vts.getParameter ("xOverF3")->setValueNotifyingHost (2500.0f);
+        vts.getParameter ("xOverF4")->setValueNotifyingHost (8000.0f);
+        referenceFile = getTestDataPath().getChildFile (
+            "Filterbank_5-band-200Hz-600Hz-2500Hz-8000Hz.wav");
+    }
+
+    Parameters params;
+    params.numBands = proc.getNProcessorBands();
+    for (unsigned int i = 0; i + 1 < params.numBands; ++i)
+        params.xOverHz[i] = hzFromZeroToOne (
+            params.numBands,
+            i,
+            vts.getRawParameterValue ("xOverF" + juce::String (i + 1))->load());
+
+    ReferenceEngine reference;
+    reference.prepare (sampleRate, params);
+
+    std::vector<float> impulse (bufferSize, 0.0f), output (bufferSize);
+    impulse[0] = 0.5f;
+    reference.process (impulse.data(), impulse.data(), output.data(), bufferSize);
+
+    juce::AudioBuffer<float> expected;
+    loadWavFile (referenceFile, expected);
+
+    float maxError = 0.0f, reconstructionError = 0.0f;
+    const auto latency = reference.getLatencySamples();
+    for (int i = 0; i < bufferSize; ++i)
+    {
+        const auto y = output[static_cast<size_t> (i)];
+        maxError = std::max (maxError, std::abs (y - expected.getSample (0, i)));
+        reconstructionError =
+            std::max (reconstructionError, std::abs (y - (i == latency ? 1.0f : 0.0f)));
+    }
+
+    // the references are stored with 24 bit
+    CAPTURE (maxError, reconstructionError);
+    REQUIRE (maxError < 1.0e-6f);
+    REQUIRE (reconstructionError < 0.1f);
+}
+
+/* The latency reported to the host has to match where the processed signal actually ends up */
+TEST_CASE ("Reported latency matches the engines", "[differential]")
+{
+    for (auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+    {
+        for (int bands = 1; bands <= MAX_NUM_EQS; ++bands)
+        {
+            for (int zeroLatency = 0; zeroLatency < 2; ++zeroLatency)
+            {
+                INFO (sampleRate << " Hz, " << bands << " bands, zero latency " << zeroLatency);
+
+                PolarDesignerAudioProcessor proc;
+                auto& vts = proc.getValueTreeState();
+                vts.getParameter ("nrBands")
+                    ->setValueNotifyingHost (static_cast<float> (bands - 1) / 4.0f);
+                vts.getParameter ("zeroLatencyMode")
+                    ->setValueNotifyingHost (static_cast<float> (zeroLatency));
+                proc.prepareToPlay (sampleRate, 512);
+
+                Parameters params;
+                params.numBands = static_cast<unsigned int> (bands);
+                params.zeroLatency = zeroLatency == 1;
+
+                // omni everywhere, so the filter bank sums up to a delayed impulse, or an
+                // allpass in zero latency mode
+                PolarDesignerDsp engine;
+                engine.setParameters (params);
+                engine.setNonRealtime (true);
+                engine.prepare (sampleRate, 512);
+
+                TestHelpers::ReferenceEngine reference;
+                reference.prepare (sampleRate, params);
+
+                const auto latency = proc.getLatencySamples();
+                REQUIRE (latency == engine.getLatencySamples (params));
+                REQUIRE (latency == reference.getLatencySamples());
+
+                std::vector<float> impulse (2048, 0.0f), output (2048);
+                impulse[0] = 0.5f;
+                engine.process (impulse.data(), impulse.data(), output.data(), 512);
+                for (size_t offset = 512; offset < output.size(); offset += 512)
+                    engine.process (impulse.data() + offset,
+                                    impulse.data() + offset,
+                                    output.data() + offset,
+                                    512);
+
+                if (zeroLatency == 1)
+                {
+                    // minimum phase bands respond right away and add up to an allpass
+                    float energy = 0.0f;
+                    for (auto y : output)
+                        energy += y * y;
+
+                    REQUIRE (std::abs (output[0]) > 0.0f);
+                    REQUIRE (energy == Catch::Approx (1.0f).margin (1.0e-3));
+                    continue;
+                }
+
+                const auto peak = std::max_element (output.begin(),
+                                                    output.end(),
+                                                    [] (float a, float b)
+                                                    { return std::abs (a) < std::abs (b); });
+                REQUIRE (std::distance (output.begin(), peak) == latency);
+            }
+        }
+    }
+}
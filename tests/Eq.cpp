@@ -45,6 +45,9 @@ TEST_CASE ("Diffuse/free field EQ: IR correctness", "[EQ]")
     auto proc = PolarDesignerAudioProcessor();
     auto& vts = proc.getValueTreeState();
 
+    // render offline, so processBlock waits for the kernels instead of falling back to a
+    // single band while they are designed
+    proc.setNonRealtime (true);
     proc.prepareToPlay (sampleRate, blockSize);
 
     // configure processor
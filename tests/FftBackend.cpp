@@ -0,0 +1,136 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#include <ComplexMultiply.hpp>
+#include <FftBackend.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <future>
+
+/* Every backend has to produce the same spectra, the convolution engine stores kernel
+ * partitions transformed by one backend and might process them with another.
+ */
+TEST_CASE ("FFT backends are interchangeable", "[fft]")
+{
+    using Catch::Matchers::WithinAbs;
+
+    for (const size_t fftSize : { 64, 1024, 4096 })
+    {
+        std::vector<float> input (fftSize);
+        juce::Random random (42);
+        for (auto& s : input)
+            s = random.nextFloat() - 0.5f;
+
+        auto reference = FftBackend::create (FftBackendType::juce, fftSize);
+        std::copy (input.begin(), input.end(), reference->getTimeData());
+        reference->forward();
+        const std::vector<float> referenceSpectrum (reference->getFrequencyData(),
+                                                    reference->getFrequencyData()
+                                                        + 2 * reference->numBins);
+
+        for (const auto type : FftBackend::getAvailableTypes())
+        {
+            INFO (FftBackend::getName (type) << ", size " << fftSize);
+            auto fft = FftBackend::create (type, fftSize);
+
+            std::copy (input.begin(), input.end(), fft->getTimeData());
+            fft->forward();
+            for (size_t i = 0; i < 2 * fft->numBins; ++i)
+                REQUIRE_THAT (fft->getFrequencyData()[i], WithinAbs (referenceSpectrum[i], 1e-4));
+
+            fft->inverse();
+            for (size_t i = 0; i < fftSize; ++i)
+                REQUIRE_THAT (fft->getTimeData()[i], WithinAbs (input[i], 1e-6));
+        }
+    }
+
+    // autotuning has to settle on an available backend and stick to it
+    const auto fastest = FftBackend::getFastestType (2048);
+    REQUIRE (FftBackend::getFastestType (2048) == fastest);
+}
+
+TEST_CASE ("Complex multiply-accumulate matches scalar version", "[fft]")
+{
+    using Catch::Matchers::WithinAbs;
+
+    constexpr size_t numBins = 513;
+    std::vector<float> a (2 * numBins), b (2 * numBins);
+    juce::Random random (7);
+    for (auto& s : a)
+        s = random.nextFloat() - 0.5f;
+    for (auto& s : b)
+        s = random.nextFloat() - 0.5f;
+
+    std::vector<float> expected (2 * numBins, 0.25f), result (2 * numBins, 0.25f);
+    complexMultiplyAccumulateScalar (expected.data(), a.data(), b.data(), numBins);
+    getComplexMultiplyAccumulate().function (result.data(), a.data(), b.data(), numBins);
+
+    for (size_t i = 0; i < 2 * numBins; ++i)
+        REQUIRE_THAT (result[i], WithinAbs (expected[i], 1e-6));
+}
+
+#if JUCE_DSP_USE_STATIC_FFTW
+TEST_CASE ("FFTW wisdom file", "[fft]")
+{
+    const juce::TemporaryFile temp (".wisdom");
+    const auto& file = temp.getFile();
+
+    // make sure there is some wisdom to export
+    FftBackend::create (FftBackendType::fftw, 512);
+
+    SECTION ("Round trip")
+    {
+        REQUIRE (FftwPlanner::exportWisdom (file));
+        REQUIRE (FftwPlanner::importWisdom (file));
+    }
+
+    SECTION ("Corrupted files are rejected")
+    {
+        REQUIRE (FftwPlanner::exportWisdom (file));
+
+        auto content = file.loadFileAsString();
+        content = content.substring (0, content.length() - 10);
+        REQUIRE (file.replaceWithText (content));
+
+        REQUIRE_FALSE (FftwPlanner::importWisdom (file));
+    }
+
+    SECTION ("Cached plans do not wait for the planner")
+    {
+        const auto backend = FftBackend::create (FftBackendType::fftw, 1024);
+
+        std::unique_lock<std::mutex> planning (FftBackend::getPlannerMutex());
+        auto another = std::async (std::launch::async,
+                                   [] { return FftBackend::create (FftBackendType::fftw, 1024); });
+        const auto status = another.wait_for (std::chrono::seconds (2));
+        planning.unlock();
+
+        REQUIRE (status == std::future_status::ready);
+    }
+
+    SECTION ("Missing files are ignored")
+    {
+        REQUIRE_FALSE (FftwPlanner::importWisdom (file.getSiblingFile ("doesNotExist.wisdom")));
+    }
+}
+#endif
@@ -51,6 +51,9 @@ TEST_CASE ("Crossover update", "[filterbank]")
     auto proc = PolarDesignerAudioProcessor();
     auto& vts = proc.getValueTreeState();
 
+    // render offline, so processBlock waits for the kernels instead of falling back to a
+    // single band while they are designed
+    proc.setNonRealtime (true);
     proc.prepareToPlay (sampleRate, bufferSize);
 
     SECTION ("2-band filterbank with 200Hz crossover")
@@ -0,0 +1,134 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+
+#include <KernelStore.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+/* Instances with identical settings have to share their kernels instead of designing
+ * their own, and kernels nobody uses anymore must not stay in the cache.
+ */
+TEST_CASE ("Kernel store sharing", "[kernelstore]")
+{
+    juce::SharedResourcePointer<KernelStore> store;
+
+    FilterBankKey key;
+    key.sampleRate = 48000.0;
+    key.firLen = 401;
+    key.partitionSize = 512;
+    key.numBands = 3;
+    key.xOverHz = { 300.0f, 2500.0f, 0.0f, 0.0f };
+
+    SECTION ("Identical settings share one kernel set")
+    {
+        auto first = store->getFilterBank (key);
+        auto second = store->getFilterBank (key);
+
+        REQUIRE (first != nullptr);
+        REQUIRE (first == second);
+        REQUIRE (first->partitioned->numKernels == 3);
+    }
+
+    SECTION ("Different crossovers get their own kernel set")
+    {
+        auto first = store->getFilterBank (key);
+        auto otherKey = key;
+        otherKey.xOverHz[1] = 3000.0f;
+        auto second = store->getFilterBank (otherKey);
+
+        REQUIRE (first != second);
+    }
+
+    SECTION ("Concurrent requests share one design")
+    {
+        auto first = store->requestFilterBank (key);
+        auto second = store->requestFilterBank (key);
+
+        first->wait();
+        second->wait();
+        REQUIRE (first->get() == second->get());
+    }
+
+    SECTION ("EQ kernels are shared per mode")
+    {
+        auto ff = store->getEq ({ 48000.0, 1, 512 });
+        auto df = store->getEq ({ 48000.0, 2, 512 });
+
+        REQUIRE (ff == store->getEq ({ 48000.0, 1, 512 }));
+        REQUIRE (ff != df);
+    }
+
+    SECTION ("Unused kernels are released")
+    {
+        const auto numBefore = store->getNumCachedKernelSets();
+        {
+            auto kernels = store->getFilterBank (key);
+            REQUIRE (store->getNumCachedKernelSets() == numBefore + 1);
+        }
+
+        // the design job might still be finishing up
+        for (int i = 0; i < 100 && store->getNumCachedKernelSets() != numBefore; ++i)
+            juce::Thread::sleep (10);
+
+        REQUIRE (store->getNumCachedKernelSets() == numBefore);
+    }
+}
+
+/* The audio thread only queues keys and picks up kernels, the request thread does the rest
+ * and frees the kernels once the last instance let go of them.
+ */
+TEST_CASE ("Kernel requests from the audio thread", "[kernelstore]")
+{
+    juce::SharedResourcePointer<KernelStore> store;
+    KernelRequests requests (*store);
+
+    FilterBankKey key;
+    key.sampleRate = 48000.0;
+    key.firLen = 401;
+    key.partitionSize = 512;
+    key.numBands = 2;
+    key.xOverHz = { 700.0f, 0.0f, 0.0f, 0.0f };
+
+    REQUIRE (requests.takeFilterBank (false) == nullptr);
+    REQUIRE (requests.queue (key));
+
+    std::weak_ptr<const FilterBankKernels> picked;
+    {
+        std::shared_ptr<const FilterBankKernels> kernels;
+        for (int i = 0; i < 500 && kernels == nullptr; ++i)
+        {
+            kernels = requests.takeFilterBank (false);
+            juce::Thread::sleep (10);
+        }
+
+        REQUIRE (kernels != nullptr);
+        REQUIRE (kernels->partitioned->numKernels == 2);
+        REQUIRE (requests.takeFilterBank (false) == nullptr);
+        picked = kernels;
+    }
+
+    // the request thread frees them
+    for (int i = 0; i < 100 && ! picked.expired(); ++i)
+        juce::Thread::sleep (10);
+
+    REQUIRE (picked.expired());
+}
@@ -0,0 +1,105 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include <MixKernels.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vector>
+
+TEST_CASE ("Mix kernels match scalar versions", "[mix]")
+{
+    using Catch::Matchers::WithinAbs;
+
+    // odd length, so the wide variants have a remainder to take care of
+    constexpr size_t numSamples = 1021;
+    juce::Random random (11);
+    const auto noise = [&random]
+    {
+        std::vector<float> v (numSamples);
+        for (auto& s : v)
+            s = random.nextFloat() - 0.5f;
+        return v;
+    };
+
+    const auto& kernels = getMixKernels();
+
+    SECTION ("Matrix")
+    {
+        const auto front = noise(), back = noise();
+        std::vector<float> omni (numSamples), eight (numSamples);
+        std::vector<float> expectedOmni (numSamples), expectedEight (numSamples);
+
+        matrixScalar (
+            front.data(), back.data(), expectedOmni.data(), expectedEight.data(), numSamples);
+        kernels.matrix (front.data(), back.data(), omni.data(), eight.data(), numSamples);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            REQUIRE_THAT (omni[i], WithinAbs (expectedOmni[i], 1e-6));
+            REQUIRE_THAT (eight[i], WithinAbs (expectedEight[i], 1e-6));
+        }
+    }
+
+    SECTION ("Ramped mix")
+    {
+        std::vector<std::vector<float>> signals;
+        signals.reserve (2 * MAX_NUM_BANDS);
+        BandMix mix;
+        mix.numBands = MAX_NUM_BANDS;
+        for (unsigned int b = 0; b < MAX_NUM_BANDS; ++b)
+        {
+            mix.omni[b] = signals.emplace_back (noise()).data();
+            mix.eight[b] = signals.emplace_back (noise()).data();
+            mix.omniStart[b] = random.nextFloat();
+            mix.omniStep[b] = (random.nextFloat() - mix.omniStart[b]) / numSamples;
+            mix.eightStart[b] = random.nextFloat() - 0.5f;
+            mix.eightStep[b] = (random.nextFloat() - 0.5f - mix.eightStart[b]) / numSamples;
+        }
+
+        // the full mix against the generic loop, every specialisation against the scalar one
+        std::vector<float> expected (numSamples), result (numSamples);
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto t = static_cast<float> (i);
+            for (unsigned int b = 0; b < MAX_NUM_BANDS; ++b)
+                expected[i] += mix.omni[b][i] * (mix.omniStart[b] + t * mix.omniStep[b])
+                               + mix.eight[b][i] * (mix.eightStart[b] + t * mix.eightStep[b]);
+        }
+
+        rampedMixScalar<MAX_NUM_BANDS> (mix, result.data(), numSamples);
+        for (size_t i = 0; i < numSamples; ++i)
+            REQUIRE_THAT (result[i], WithinAbs (expected[i], 1e-5));
+
+        const auto scalar =
+            makeRampedMixScalarTable (std::make_index_sequence<MAX_NUM_BANDS + 1>());
+        for (unsigned int numBands = 0; numBands <= MAX_NUM_BANDS; ++numBands)
+        {
+            INFO (numBands << " bands");
+            mix.numBands = numBands;
+            scalar[numBands] (mix, expected.data(), numSamples);
+            kernels.rampedMix[numBands] (mix, result.data(), numSamples);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                REQUIRE_THAT (result[i], WithinAbs (expected[i], 1e-5));
+        }
+    }
+}
@@ -0,0 +1,298 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include <algorithm>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <dsp/PolarDesignerDsp.h>
+#include <utility>
+#include <vector>
+
+/* The DSP core has to run on its own, without a processor, editor or message thread. */
+TEST_CASE ("DSP core without the plugin", "[dsp]")
+{
+    constexpr int blockSize = 256;
+
+    PolarDesignerDsp dsp;
+    PolarDesignerDsp::Parameters params;
+    params.numBands = 1;
+    params.dirFactors[0] = 0.0f; // omni
+
+    dsp.setParameters (params);
+    dsp.prepare (48000.0, blockSize);
+    REQUIRE (dsp.isPrepared());
+
+    const auto latency = dsp.getLatencySamples (params);
+    REQUIRE (latency > 0);
+    REQUIRE (latency < 4 * blockSize);
+
+    SECTION ("Zero latency mode reports no latency")
+    {
+        params.zeroLatency = true;
+        REQUIRE (dsp.getLatencySamples (params) == 0);
+    }
+
+    SECTION ("Quality tiers trade latency for steeper crossovers")
+    {
+        params.quality = FilterBankQuality::eco;
+        const auto eco = dsp.getLatencySamples (params);
+        params.quality = FilterBankQuality::high;
+        const auto high = dsp.getLatencySamples (params);
+
+        REQUIRE (eco < latency);
+        REQUIRE (high > latency);
+
+        // no prepare() needed, the single band path follows with the new delay right away
+        dsp.setParameters (params);
+        std::vector<float> front (blockSize), back (blockSize), output (blockSize);
+        std::vector<float> rendered;
+        for (int block = 0; block * blockSize < high + blockSize; ++block)
+        {
+            std::fill (front.begin(), front.end(), 0.0f);
+            front[0] = block == 0 ? 1.0f : 0.0f;
+            dsp.process (front.data(), back.data(), output.data(), blockSize);
+            rendered.insert (rendered.end(), output.begin(), output.end());
+        }
+
+        REQUIRE (rendered[static_cast<size_t> (high)] == Catch::Approx (1.0f));
+    }
+
+    SECTION ("A single omni band delays front + back")
+    {
+        std::vector<float> front (blockSize), back (blockSize), output (blockSize);
+        std::vector<float> rendered;
+
+        for (int block = 0; block * blockSize < latency + blockSize; ++block)
+        {
+            std::fill (front.begin(), front.end(), 0.0f);
+            std::fill (back.begin(), back.end(), 0.0f);
+            if (block == 0)
+            {
+                front[0] = 0.25f;
+                back[0] = 0.5f;
+            }
+
+            dsp.process (front.data(), back.data(), output.data(), blockSize);
+            rendered.insert (rendered.end(), output.begin(), output.end());
+        }
+
+        REQUIRE (rendered[static_cast<size_t> (latency)] == Catch::Approx (0.75f));
+        for (size_t i = 0; i < rendered.size(); ++i)
+            if (i != static_cast<size_t> (latency))
+                REQUIRE (rendered[i] == Catch::Approx (0.0f).margin (1e-6));
+    }
+
+    SECTION ("Scratch memory is one block, sized in prepare")
+    {
+        const auto scratchSize = dsp.getScratchMemorySize();
+        REQUIRE (scratchSize > 0);
+        REQUIRE (scratchSize % ScratchArena::alignment == 0);
+
+        // host blocks larger than announced are split up instead of growing any buffer
+        constexpr int hostBlockSize = 3 * blockSize;
+        std::vector<float> front (hostBlockSize, 0.1f), back (hostBlockSize);
+        std::vector<float> output (hostBlockSize);
+        dsp.process (front.data(), back.data(), output.data(), hostBlockSize);
+        REQUIRE (dsp.getScratchMemorySize() == scratchSize);
+    }
+
+    SECTION ("Silent input idles and resumes seamlessly")
+    {
+        std::vector<float> front (blockSize), back (blockSize), output (blockSize);
+
+        const auto renderImpulse = [&]
+        {
+            std::vector<float> rendered;
+            for (int block = 0; block * blockSize < latency + blockSize; ++block)
+            {
+                std::fill (front.begin(), front.end(), 0.0f);
+                std::fill (back.begin(), back.end(), 0.0f);
+                front[0] = block == 0 ? 0.5f : 0.0f;
+
+                dsp.process (front.data(), back.data(), output.data(), blockSize);
+                rendered.insert (rendered.end(), output.begin(), output.end());
+            }
+            return rendered;
+        };
+
+        const auto first = renderImpulse();
+
+        std::fill (front.begin(), front.end(), 0.0f);
+        for (int block = 0; block < 16; ++block)
+            dsp.process (front.data(), back.data(), output.data(), blockSize);
+
+        REQUIRE (dsp.isIdle());
+        for (auto sample : output)
+            REQUIRE (sample == 0.0f);
+
+        const auto second = renderImpulse();
+        REQUIRE_FALSE (dsp.isIdle());
+        REQUIRE (second == first);
+    }
+
+    SECTION ("Zero latency mode keeps the bands apart")
+    {
+        params.numBands = 2;
+        params.xOverHz[0] = 1000.0f;
+        params.zeroLatency = true;
+
+        // a low tone, front only, so omni and eight carry the same signal
+        constexpr int numBlocks = 40;
+        std::vector<float> front (blockSize), back (blockSize), output (blockSize);
+        int position = 0;
+
+        const auto renderPeak = [&] (bool muteLow, bool muteHigh)
+        {
+            params.mute[0] = muteLow;
+            params.mute[1] = muteHigh;
+            dsp.setParameters (params);
+
+            float peak = 0.0f;
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (auto& sample : front)
+                    sample = 0.5f * std::sin (juce::MathConstants<float>::twoPi * 100.0f
+                                              * static_cast<float> (position++) / 48000.0f);
+
+                dsp.process (front.data(), back.data(), output.data(), blockSize);
+
+                // after the gain ramp and the crossover transients
+                if (block >= numBlocks / 2)
+                    for (auto sample : output)
+                        peak = std::max (peak, std::abs (sample));
+            }
+            return peak;
+        };
+
+        REQUIRE (dsp.getLatencySamples (params) == 0);
+        REQUIRE (renderPeak (false, true) == Catch::Approx (0.5f).margin (0.01));
+        REQUIRE (renderPeak (true, false) < 0.005f);
+    }
+
+    SECTION ("The second output sounds like an engine of its own")
+    {
+        params.numBands = 3;
+        params.xOverHz = getBandLayout (3).initXOverHz;
+        params.dirFactors = { 0.0f, 0.5f, 1.0f };
+        params.gainsDb = { 0.0f, -6.0f, 3.0f };
+
+        auto second = params;
+        second.dirFactors = { 1.0f, -0.5f, 0.25f };
+        second.gainsDb = { -3.0f, 0.0f, 6.0f };
+
+        params.secondOutput = true;
+        params.secondDirFactors = second.dirFactors;
+        params.secondGainsDb = second.gainsDb;
+
+        constexpr int numBlocks = 12;
+        juce::Random random (0x2d1c);
+        std::vector<float> front (numBlocks * blockSize), back (numBlocks * blockSize);
+        for (size_t i = 0; i < front.size(); ++i)
+        {
+            front[i] = random.nextFloat() - 0.5f;
+            back[i] = random.nextFloat() - 0.5f;
+        }
+
+        // the second output overwrites the back channel, like the processor does
+        const auto render = [&] (const PolarDesignerDsp::Parameters& p, bool both)
+        {
+            PolarDesignerDsp engine;
+            engine.setNonRealtime (true);
+            engine.setParameters (p);
+            engine.prepare (48000.0, blockSize);
+
+            std::vector<float> output (front.size()), secondOutput (back);
+            for (size_t offset = 0; offset < front.size(); offset += blockSize)
+                engine.process (front.data() + offset,
+                                secondOutput.data() + offset,
+                                output.data() + offset,
+                                both ? secondOutput.data() + offset : nullptr,
+                                blockSize);
+            return std::pair { output, secondOutput };
+        };
+
+        const auto both = render (params, true);
+        params.secondOutput = false;
+        const auto mainOnly = render (params, false).first;
+        const auto secondOnly = render (second, false).first;
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < mainOnly.size(); ++i)
+            maxError = std::max ({ maxError,
+                                   std::abs (both.first[i] - mainOnly[i]),
+                                   std::abs (both.second[i] - secondOnly[i]) });
+        REQUIRE (maxError < 1.0e-5f);
+    }
+
+    SECTION ("The monitor plays the pattern without latency")
+    {
+        params.numBands = 3;
+        params.xOverHz = getBandLayout (3).initXOverHz;
+        params.dirFactors = { 0.0f, 0.0f, 0.0f };
+        params.monitorOutput = true;
+
+        const auto renderImpulse = [&]
+        {
+            PolarDesignerDsp engine;
+            engine.setNonRealtime (true);
+            engine.setParameters (params);
+            engine.prepare (48000.0, blockSize);
+
+            std::vector<float> front (blockSize), back (blockSize);
+            std::vector<float> output (blockSize), monitor (blockSize);
+            std::vector<float> rendered, monitored;
+            for (int block = 0; block < 4; ++block)
+            {
+                std::fill (front.begin(), front.end(), 0.0f);
+                front[0] = block == 0 ? 0.5f : 0.0f;
+                engine.process (front.data(),
+                                back.data(),
+                                output.data(),
+                                nullptr,
+                                monitor.data(),
+                                blockSize);
+                rendered.insert (rendered.end(), output.begin(), output.end());
+                monitored.insert (monitored.end(), monitor.begin(), monitor.end());
+            }
+            return std::pair { rendered, monitored };
+        };
+
+        // the crossovers add up to an allpass, which responds right away
+        const auto linearPhase = renderImpulse();
+        const auto mainLatency = static_cast<size_t> (dsp.getLatencySamples (params));
+        REQUIRE (linearPhase.first[mainLatency] == Catch::Approx (0.5f).margin (1e-3));
+        REQUIRE (std::abs (linearPhase.first[0]) < 1e-3f);
+        REQUIRE (std::abs (linearPhase.second[0]) > 0.05f);
+
+        params.zeroLatency = true;
+        const auto zeroLatency = renderImpulse();
+        REQUIRE (zeroLatency.second == zeroLatency.first);
+    }
+
+    SECTION ("Tracking without audio does not produce a pattern")
+    {
+        dsp.startTracking (false);
+        REQUIRE (dsp.isTracking());
+        REQUIRE_FALSE (dsp.stopTracking());
+        REQUIRE_FALSE (dsp.isTracking());
+    }
+}
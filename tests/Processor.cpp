@@ -21,6 +21,7 @@
  */
 
 #include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <juce_audio_basics/juce_audio_basics.h>
 
@@ -84,3 +85,274 @@ TEST_CASE ("Processor: base latency", "[Processor]")
         REQUIRE (proc.getLatencySamples() == 401);
     }
 }
+
+TEST_CASE ("Processor: offline renders use large partitions", "[Processor]")
+{
+    PolarDesignerAudioProcessor proc;
+    juce::MidiBuffer midiBuffer;
+
+    SECTION ("Announced before prepareToPlay")
+    {
+        proc.setNonRealtime (true);
+        proc.prepareToPlay (48000, 8192);
+        REQUIRE (proc.getPerfCounters().partitionSize == PD_OFFLINE_PROCESSING_QUANTUM);
+
+        proc.setNonRealtime (false);
+        proc.prepareToPlay (48000, 8192);
+        REQUIRE (proc.getPerfCounters().partitionSize == PD_DEFAULT_PROCESSING_QUANTUM);
+    }
+
+    SECTION ("Switched or grown without prepareToPlay")
+    {
+        proc.prepareToPlay (48000, 256);
+        REQUIRE (proc.getPerfCounters().partitionSize == 256);
+
+        proc.setNonRealtime (true);
+        juce::AudioBuffer<float> buffer (2, 2048);
+        buffer.clear();
+        proc.processBlock (buffer, midiBuffer);
+        REQUIRE (proc.getPerfCounters().partitionSize == 2048);
+
+        // the latency does not depend on the partitions
+        REQUIRE (proc.getLatencySamples() == 200);
+    }
+
+    SECTION ("Back to realtime without prepareToPlay")
+    {
+        proc.prepareToPlay (48000, 256);
+        proc.setNonRealtime (true);
+        juce::AudioBuffer<float> buffer (2, 2048);
+        buffer.clear();
+        proc.processBlock (buffer, midiBuffer);
+        REQUIRE (proc.getPerfCounters().partitionSize == 2048);
+
+        // nothing is rebuilt while audio may be running, the next prepareToPlay does it
+        proc.setNonRealtime (false);
+        juce::AudioBuffer<float> block (2, 256);
+        block.clear();
+        proc.processBlock (block, midiBuffer);
+        proc.timerCallback();
+        REQUIRE (proc.getPerfCounters().partitionSize == 2048);
+
+        proc.prepareToPlay (48000, 256);
+        REQUIRE (proc.getPerfCounters().partitionSize == 256);
+    }
+}
+
+TEST_CASE ("Processor: multi-pair layouts", "[Processor]")
+{
+    constexpr int numPairs = 3;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 8;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (juce::AudioChannelSet::discreteChannels (2 * numPairs));
+    layout.outputBuses.add (juce::AudioChannelSet::discreteChannels (numPairs));
+    layout.outputBuses.add (juce::AudioChannelSet::disabled());
+    layout.outputBuses.add (juce::AudioChannelSet::disabled());
+
+    PolarDesignerAudioProcessor proc;
+    juce::MidiBuffer midiBuffer;
+
+    SECTION ("Layouts")
+    {
+        REQUIRE (proc.checkBusesLayoutSupported (layout));
+
+        auto oddInputs = layout;
+        oddInputs.inputBuses.getReference (0) = juce::AudioChannelSet::discreteChannels (5);
+        REQUIRE_FALSE (proc.checkBusesLayoutSupported (oddInputs));
+
+        auto tooFewOutputs = layout;
+        tooFewOutputs.outputBuses.getReference (0) = juce::AudioChannelSet::stereo();
+        REQUIRE_FALSE (proc.checkBusesLayoutSupported (tooFewOutputs));
+
+        auto secondOutput = layout;
+        secondOutput.outputBuses.getReference (1) = juce::AudioChannelSet::mono();
+        REQUIRE_FALSE (proc.checkBusesLayoutSupported (secondOutput));
+
+        auto tooManyPairs = layout;
+        tooManyPairs.inputBuses.getReference (0) =
+            juce::AudioChannelSet::discreteChannels (2 * MAX_NUM_PAIRS + 2);
+        tooManyPairs.outputBuses.getReference (0) =
+            juce::AudioChannelSet::discreteChannels (MAX_NUM_PAIRS + 1);
+        REQUIRE_FALSE (proc.checkBusesLayoutSupported (tooManyPairs));
+    }
+
+    SECTION ("Every pair sounds like an instance of its own")
+    {
+        // the second pair plays its own pattern, an eight with a lower gain
+        const auto setPattern =
+            [] (juce::AudioProcessorValueTreeState& vts, int pair, float alpha, float gain)
+        {
+            for (size_t i = 1; i < MAX_NUM_EQS + 1; ++i)
+            {
+                auto* alphaParam = vts.getParameter (
+                    pair == 1 ? "alpha" + juce::String (i)
+                              : PolarDesignerAudioProcessor::getPairParameterID (pair, "Alpha", i));
+                auto* gainParam = vts.getParameter (
+                    pair == 1 ? "gain" + juce::String (i)
+                              : PolarDesignerAudioProcessor::getPairParameterID (pair, "Gain", i));
+                alphaParam->setValueNotifyingHost (alphaParam->convertTo0to1 (alpha));
+                gainParam->setValueNotifyingHost (gainParam->convertTo0to1 (gain));
+            }
+        };
+        setPattern (proc.getValueTreeState(), 2, 1.0f, -6.0f);
+
+        REQUIRE (proc.setBusesLayout (layout));
+        proc.setNonRealtime (true);
+        proc.prepareToPlay (48000, blockSize);
+        REQUIRE (proc.getNumPairs() == numPairs);
+        REQUIRE (proc.getLatencySamples() == 200);
+
+        juce::Random random (0x5047);
+        juce::AudioBuffer<float> input (2 * numPairs, numBlocks * blockSize);
+        for (int ch = 0; ch < input.getNumChannels(); ++ch)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample (ch, i, random.nextFloat() - 0.5f);
+
+        juce::AudioBuffer<float> output (numPairs, input.getNumSamples());
+        juce::AudioBuffer<float> block (2 * numPairs, blockSize);
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                block.copyFrom (ch, 0, input, ch, b * blockSize, blockSize);
+            proc.processBlock (block, midiBuffer);
+            for (int pair = 0; pair < numPairs; ++pair)
+                output.copyFrom (pair, b * blockSize, block, pair, 0, blockSize);
+        }
+
+        for (int pair = 0; pair < numPairs; ++pair)
+        {
+            INFO ("pair " << pair);
+            REQUIRE (output.getRMSLevel (pair, 0, output.getNumSamples()) > 0.01f);
+
+            PolarDesignerAudioProcessor single;
+            if (pair == 1)
+                setPattern (single.getValueTreeState(), 1, 1.0f, -6.0f);
+            single.setNonRealtime (true);
+            single.prepareToPlay (48000, blockSize);
+
+            juce::AudioBuffer<float> stereo (2, blockSize);
+            float maxError = 0.0f;
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                stereo.copyFrom (0, 0, input, 2 * pair, b * blockSize, blockSize);
+                stereo.copyFrom (1, 0, input, 2 * pair + 1, b * blockSize, blockSize);
+                single.processBlock (stereo, midiBuffer);
+
+                for (int i = 0; i < blockSize; ++i)
+                    maxError = std::max (maxError,
+                                         std::abs (stereo.getSample (0, i)
+                                                   - output.getSample (pair, b * blockSize + i)));
+            }
+
+            REQUIRE (maxError < 1.0e-6f);
+        }
+    }
+}
+
+TEST_CASE ("Processor: state", "[Processor]")
+{
+    PolarDesignerAudioProcessor proc;
+    proc.prepareToPlay (48000, 256);
+    proc.getValueTreeState().getParameter ("alpha2")->setValueNotifyingHost (0.25f);
+    proc.setEqState (1);
+
+    PolarDesignerAudioProcessor restored;
+    restored.prepareToPlay (48000, 256);
+
+    auto requireRestored = [&]
+    {
+        auto* alpha = restored.getValueTreeState().getParameter ("alpha2");
+        REQUIRE (alpha->getValue() == Catch::Approx (0.25f).margin (1e-3));
+        REQUIRE (restored.getEqState() == 1);
+    };
+
+    SECTION ("binary round trip")
+    {
+        juce::MemoryBlock state;
+        proc.getStateInformation (state);
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        requireRestored();
+    }
+
+    SECTION ("legacy xml sessions")
+    {
+        auto params = proc.getValueTreeState().copyState();
+        params.setProperty ("ffDfEq", 1, nullptr);
+
+        juce::ValueTree saveStates ("save");
+        saveStates.addChild (params.createCopy(), 0, nullptr);
+        saveStates.addChild (params.createCopy(), 1, nullptr);
+        saveStates.addChild (params.createCopy(), 2, nullptr);
+
+        juce::MemoryBlock state;
+        juce::AudioProcessor::copyXmlToBinary (*saveStates.createXml(), state);
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        requireRestored();
+    }
+
+    SECTION ("newer formats are rejected")
+    {
+        juce::MemoryBlock state;
+        proc.getStateInformation (state);
+
+        // bump the format version behind the magic
+        auto* version = static_cast<char*> (state.getData()) + 4;
+        const auto newer = juce::ByteOrder::swapIfBigEndian (
+            juce::ByteOrder::littleEndianInt (version) + 1);
+        std::memcpy (version, &newer, sizeof (newer));
+
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+        auto* alpha = restored.getValueTreeState().getParameter ("alpha2");
+        REQUIRE (alpha->getValue() != Catch::Approx (0.25f).margin (1e-3));
+        REQUIRE (restored.getEqState() == 0);
+    }
+
+    SECTION ("invalid states load the defaults")
+    {
+        auto& vts = restored.getValueTreeState();
+        vts.getParameter ("gain2")->setValueNotifyingHost (0.9f);
+        vts.getParameter ("secondGain2")->setValueNotifyingHost (0.9f);
+        vts.getParameter ("filterBankQuality")->setValueNotifyingHost (1.0f);
+        vts.getParameter ("qualityGovernor")->setValueNotifyingHost (1.0f);
+        vts.getParameter ("sharedWorkers")->setValueNotifyingHost (1.0f);
+
+        const char garbage[] = "no PolarDesigner state";
+        restored.setStateInformation (garbage, static_cast<int> (sizeof (garbage)));
+
+        const auto plainValue = [&vts] (const char* paramID)
+        {
+            auto* param = vts.getParameter (paramID);
+            return param->convertFrom0to1 (param->getValue());
+        };
+        REQUIRE (plainValue ("gain2") == Catch::Approx (0.0f).margin (1e-3));
+        REQUIRE (plainValue ("secondGain2") == Catch::Approx (0.0f).margin (1e-3));
+        REQUIRE (plainValue ("filterBankQuality")
+                 == static_cast<float> (FilterBankQuality::standard));
+        REQUIRE (plainValue ("qualityGovernor") == 0.0f);
+        REQUIRE (plainValue ("sharedWorkers") == 0.0f);
+    }
+
+    SECTION ("cached until something changes")
+    {
+        juce::MemoryBlock first, second, third, fourth, fifth;
+        proc.getStateInformation (first);
+        proc.getStateInformation (second);
+        REQUIRE (first == second);
+
+        proc.getValueTreeState().getParameter ("alpha2")->setValueNotifyingHost (0.5f);
+        proc.getStateInformation (third);
+        REQUIRE (third != first);
+
+        // the pattern of the second output is part of the state as well
+        proc.getValueTreeState().getParameter ("secondAlpha2")->setValueNotifyingHost (0.5f);
+        proc.getStateInformation (fourth);
+        REQUIRE (fourth != third);
+
+        proc.getValueTreeState().getParameter ("sharedWorkers")->setValueNotifyingHost (1.0f);
+        proc.getStateInformation (fifth);
+        REQUIRE (fifth != fourth);
+    }
+}
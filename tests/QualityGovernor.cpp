@@ -0,0 +1,110 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include <QualityGovernor.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("Quality governor follows the measured load", "[governor]")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480; // 10 ms
+    constexpr double blockSeconds = blockSize / sampleRate;
+    constexpr auto selected = FilterBankQuality::high;
+
+    QualityGovernor governor;
+    governor.prepare (sampleRate);
+    REQUIRE (governor.getQuality (selected) == selected);
+
+    // feeds blocks with the given load until the quality changes, returns the elapsed seconds
+    const auto runUntilChange = [&] (double load, bool idle, bool stopped, double maxSeconds)
+    {
+        for (double t = 0.0; t < maxSeconds; t += blockSeconds)
+            if (governor.addBlock (load * blockSeconds, blockSize, idle, stopped, selected))
+                return t;
+        return -1.0;
+    };
+
+    SECTION ("Sustained overload steps down one tier at a time")
+    {
+        const auto first = runUntilChange (0.8, false, true, 10.0);
+        REQUIRE (first >= QualityGovernor::stepDownSeconds);
+        REQUIRE (governor.getQuality (selected) == FilterBankQuality::standard);
+
+        REQUIRE (runUntilChange (0.8, false, true, 10.0) > 0.0);
+        REQUIRE (governor.getQuality (selected) == FilterBankQuality::eco);
+
+        // there is nothing below eco
+        REQUIRE (runUntilChange (0.8, false, true, 10.0) < 0.0);
+    }
+
+    SECTION ("The latency never changes while the signal runs")
+    {
+        REQUIRE (runUntilChange (0.8, false, false, 10.0) < 0.0);
+        REQUIRE (governor.getQuality (selected) == selected);
+
+        // the first silent block is a boundary, the overload has been counted meanwhile
+        REQUIRE (runUntilChange (0.0, true, false, 1.0) == 0.0);
+        REQUIRE (governor.getQuality (selected) == FilterBankQuality::standard);
+
+        // so is a stopped transport
+        REQUIRE (runUntilChange (0.8, false, false, 10.0) < 0.0);
+        REQUIRE (runUntilChange (0.8, false, true, 1.0) == 0.0);
+        REQUIRE (governor.getQuality (selected) == FilterBankQuality::eco);
+    }
+
+    SECTION ("Short load peaks are ignored")
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            REQUIRE (runUntilChange (0.8, false, true, 0.5) < 0.0);
+            REQUIRE (runUntilChange (0.05, false, true, 1.0) < 0.0);
+        }
+        REQUIRE (governor.getQuality (selected) == selected);
+    }
+
+    SECTION ("Stepping up waits for low load and silence")
+    {
+        REQUIRE (runUntilChange (0.8, false, true, 10.0) > 0.0);
+        REQUIRE (governor.getQuality (selected) == FilterBankQuality::standard);
+
+        // low load alone is not enough while audio is running
+        REQUIRE (runUntilChange (0.05, false, false, 2 * QualityGovernor::stepUpSeconds) < 0.0);
+
+        REQUIRE (runUntilChange (0.0, true, false, 1.0) == 0.0);
+        REQUIRE (governor.getQuality (selected) == selected);
+    }
+
+    SECTION ("The governor never raises above the selected quality")
+    {
+        REQUIRE (governor.getQuality (FilterBankQuality::eco) == FilterBankQuality::eco);
+        REQUIRE (runUntilChange (0.8, false, true, 10.0) > 0.0);
+        REQUIRE (governor.getQuality (FilterBankQuality::eco) == FilterBankQuality::eco);
+    }
+
+    SECTION ("Reset lifts the limit")
+    {
+        REQUIRE_FALSE (governor.reset());
+        REQUIRE (runUntilChange (0.8, false, true, 10.0) > 0.0);
+        REQUIRE (governor.reset());
+        REQUIRE (governor.getQuality (selected) == selected);
+    }
+}
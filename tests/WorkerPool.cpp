@@ -0,0 +1,140 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include <WorkerPool.hpp>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+TEST_CASE ("Worker pool runs every task exactly once", "[workers]")
+{
+    constexpr int maxTasks = 8;
+    std::array<std::atomic<int>, maxTasks> counts {};
+    std::atomic<int> tasksOnCaller { 0 };
+    const auto caller = std::this_thread::get_id();
+
+    auto task = [&] (int index)
+    {
+        counts[static_cast<size_t> (index)].fetch_add (1);
+        if (std::this_thread::get_id() == caller)
+            tasksOnCaller.fetch_add (1);
+    };
+
+    // returns the number of tasks run
+    const auto runJobs = [&] (WorkerPool& pool, int numJobs)
+    {
+        int numRun = 0;
+        for (int job = 0; job < numJobs; ++job)
+        {
+            const auto numTasks = job % (maxTasks + 1);
+            for (auto& count : counts)
+                count = 0;
+
+            pool.run (numTasks, task);
+
+            for (int i = 0; i < maxTasks; ++i)
+                REQUIRE (counts[static_cast<size_t> (i)].load() == (i < numTasks ? 1 : 0));
+            numRun += numTasks;
+        }
+        return numRun;
+    };
+
+    WorkerPool pool;
+
+    SECTION ("Without workers the caller runs all tasks")
+    {
+        const auto numRun = runJobs (pool, 20);
+        REQUIRE (tasksOnCaller.load() == numRun);
+    }
+
+    SECTION ("Back to back jobs")
+    {
+        pool.start (2);
+        REQUIRE (pool.getNumWorkers() == 2);
+        runJobs (pool, 10000);
+    }
+
+    // the caller usually takes all tasks before the parked workers wake up
+    SECTION ("Jobs after the workers parked")
+    {
+        pool.start (2);
+        for (int i = 0; i < 10; ++i)
+        {
+            std::this_thread::sleep_for (std::chrono::milliseconds (5));
+            runJobs (pool, 10);
+        }
+    }
+
+    SECTION ("Stopped pools run serially")
+    {
+        pool.start (1);
+        runJobs (pool, 100);
+        pool.stop();
+        REQUIRE (pool.getNumWorkers() == 0);
+
+        tasksOnCaller = 0;
+        const auto numRun = runJobs (pool, 9);
+        REQUIRE (tasksOnCaller.load() == numRun);
+    }
+}
+
+TEST_CASE ("Worker pool takes jobs from concurrent callers", "[workers]")
+{
+    constexpr int numCallers = 6;
+    constexpr int numJobs = 2000;
+
+    // fewer slots than callers, the rest runs inline
+    WorkerPool pool (4);
+    pool.start (2);
+
+    std::atomic<int> numWrong { 0 };
+
+    const auto caller = [&] (int seed)
+    {
+        std::array<std::atomic<int>, 8> counts {};
+        auto task = [&] (int index) { counts[static_cast<size_t> (index)].fetch_add (1); };
+
+        for (int job = 0; job < numJobs; ++job)
+        {
+            const auto numTasks = 1 + (job + seed) % 8;
+            for (auto& count : counts)
+                count = 0;
+
+            const auto numHelped = pool.run (numTasks, task);
+            if (numHelped < 0 || numHelped > numTasks)
+                ++numWrong;
+
+            for (int i = 0; i < 8; ++i)
+                if (counts[static_cast<size_t> (i)].load() != (i < numTasks ? 1 : 0))
+                    ++numWrong;
+        }
+    };
+
+    std::vector<std::thread> callers;
+    for (int i = 0; i < numCallers; ++i)
+        callers.emplace_back (caller, i);
+    for (auto& thread : callers)
+        thread.join();
+
+    REQUIRE (numWrong.load() == 0);
+}
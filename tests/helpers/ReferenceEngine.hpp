@@ -0,0 +1,254 @@
+/*
+ ==============================================================================
+ ReferenceEngine.hpp
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <KernelStore.hpp>
+#include <dsp/PolarDesignerDsp.h>
+#include <vector>
+
+namespace TestHelpers
+{
+/* Straightforward sample by sample implementation of the PolarDesigner signal chain, the
+ * ground truth for PolarDesignerDsp and any faster engine replacing it. It convolves in the
+ * time domain with the same kernel designs and has no partitions, SIMD or kernel crossfades,
+ * so settings that change the kernels (bands, crossovers, EQ mode, sample rate) need a new
+ * prepare(). Pattern, gain, solo/mute and proximity changes are ramped per process() call
+ * exactly like the engine does. The zero latency bands run through the same Linkwitz-Riley
+ * filters, sample by sample instead of block by block.
+ */
+class ReferenceEngine
+{
+public:
+    using Parameters = PolarDesignerDsp::Parameters;
+
+    void prepare (double newSampleRate, const Parameters& params)
+    {
+        sampleRate = newSampleRate;
+        parameters = params;
+
+        const auto firLen = PolarDesignerDsp::getFilterBankLength (sampleRate, params.quality);
+        numBands = params.numBands;
+        delayLength = params.zeroLatency ? 0 : (firLen - 1) / 2;
+
+        if (numBands > 1 && params.zeroLatency)
+            prepareCrossovers (params);
+        else if (numBands > 1)
+        {
+            FilterBankKey key;
+            key.sampleRate = sampleRate;
+            key.firLen = firLen;
+            key.numBands = numBands;
+            key.xOverHz = params.xOverHz;
+            firs = KernelStore::designFilterBank (key);
+        }
+
+        eqActive = (params.eqMode == 1 || params.eqMode == 2) && ! params.zeroLatency;
+        if (eqActive)
+            eqIrs = KernelStore::designEq (sampleRate, params.eqMode);
+
+        historyLength = std::max (firLen, eqActive ? eqIrs.getNumSamples() : 1);
+        for (auto* history : { &omniIn, &eightIn, &omniEq, &eightEq })
+            history->assign (static_cast<size_t> (historyLength), 0.0f);
+
+        delayLine.assign (static_cast<size_t> (delayLength + 1), 0.0f);
+        position = 0;
+        delayPosition = 0;
+        proxState = 0.0f;
+
+        oldDirFactors.fill (0.0f);
+        oldGainsDb.fill (0.0f);
+    }
+
+    // only the settings that do not need new kernels may change between prepare() calls
+    void setParameters (const Parameters& params) { parameters = params; }
+
+    void process (const float* front, const float* back, float* output, int numSamples)
+    {
+        using namespace juce;
+
+        const auto prox = PolarDesignerDsp::designProxCompCoefficients (parameters.proximity,
+                                                                        sampleRate);
+
+        bool soloActive = false;
+        for (unsigned int b = 0; b < parameters.numBands; ++b)
+            soloActive = soloActive || parameters.solo[b];
+
+        // silent bands keep their previous ramp targets, as in the engine
+        std::array<bool, MAX_NUM_BANDS> silent {};
+        for (unsigned int b = 0; b < numBands; ++b)
+            silent[b] = (parameters.mute[b] && ! parameters.solo[b])
+                        || (soloActive && ! parameters.solo[b]);
+
+        std::array<float, MAX_NUM_BANDS> omniGain {}, eightGain {}, omniStep {}, eightStep {};
+        for (size_t b = 0; b < numBands; ++b)
+        {
+            const auto oldGain = Decibels::decibelsToGain (oldGainsDb[b], -59.91f);
+            const auto gain = Decibels::decibelsToGain (parameters.gainsDb[b], -59.91f);
+            const auto dirFactor = parameters.dirFactors[b];
+
+            omniGain[b] = (1 - std::abs (oldDirFactors[b])) * oldGain;
+            eightGain[b] = oldDirFactors[b] * oldGain;
+            omniStep[b] = ((1 - std::abs (dirFactor)) * gain - omniGain[b]) / numSamples;
+            eightStep[b] = (dirFactor * gain - eightGain[b]) / numSamples;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto omni = front[i] + back[i];
+            auto eight = front[i] - back[i];
+
+            if (! parameters.zeroLatency && std::abs (parameters.proximity) > 0.05f)
+            {
+                auto& x = parameters.proximity < 0.0f ? eight : omni;
+                const auto y = prox[0] * x + proxState;
+                proxState = prox[1] * x - prox[2] * y;
+                x = y;
+            }
+
+            omniIn[static_cast<size_t> (position)] = omni;
+            eightIn[static_cast<size_t> (position)] = eight;
+
+            if (eqActive)
+            {
+                omni = convolve (omniIn, eqIrs.getReadPointer (0), eqIrs.getNumSamples());
+                eight = convolve (eightIn, eqIrs.getReadPointer (1), eqIrs.getNumSamples());
+            }
+            omniEq[static_cast<size_t> (position)] = omni;
+            eightEq[static_cast<size_t> (position)] = eight;
+
+            std::array<float, MAX_NUM_BANDS> omniBands {}, eightBands {};
+            if (numBands > 1 && parameters.zeroLatency)
+            {
+                splitBands (0, omni, omniBands);
+                splitBands (1, eight, eightBands);
+            }
+
+            float mix = 0.0f;
+            for (unsigned int b = 0; b < numBands; ++b)
+            {
+                if (! silent[b])
+                {
+                    auto bandOmni = omni, bandEight = eight;
+                    if (numBands > 1 && parameters.zeroLatency)
+                    {
+                        bandOmni = omniBands[b];
+                        bandEight = eightBands[b];
+                    }
+                    else if (numBands > 1)
+                    {
+                        const auto* fir = firs.getReadPointer (static_cast<int> (b));
+                        bandOmni = convolve (omniEq, fir, firs.getNumSamples());
+                        bandEight = convolve (eightEq, fir, firs.getNumSamples());
+                    }
+
+                    mix += bandOmni * omniGain[b] + bandEight * eightGain[b];
+                }
+
+                omniGain[b] += omniStep[b];
+                eightGain[b] += eightStep[b];
+            }
+
+            // the single band path is delayed to match the latency of the filter bank
+            delayLine[static_cast<size_t> (delayPosition)] = mix;
+            delayPosition = (delayPosition + 1) % static_cast<int> (delayLine.size());
+
+            output[i] = numBands == 1 ? delayLine[static_cast<size_t> (delayPosition)] : mix;
+            position = (position + 1) % historyLength;
+        }
+
+        for (unsigned int b = 0; b < numBands; ++b)
+        {
+            if (silent[b])
+                continue;
+
+            oldDirFactors[b] = parameters.dirFactors[b];
+            oldGainsDb[b] = parameters.gainsDb[b];
+        }
+    }
+
+    int getLatencySamples() const
+    {
+        return delayLength + (eqActive ? KernelStore::getEqLatency (sampleRate) : 0);
+    }
+
+private:
+    Parameters parameters;
+    double sampleRate = 48000.0;
+    unsigned int numBands = 1;
+    bool eqActive = false;
+
+    juce::AudioBuffer<float> firs, eqIrs;
+    std::vector<float> omniIn, eightIn, omniEq, eightEq, delayLine;
+    int historyLength = 1, position = 0, delayLength = 0, delayPosition = 0;
+    float proxState = 0.0f;
+
+    std::array<float, MAX_NUM_BANDS> oldDirFactors {}, oldGainsDb {};
+
+    // zero latency crossovers, allpasses[j][k] aligns band j to crossover k
+    using Filter = juce::dsp::LinkwitzRileyFilter<float>;
+    std::array<Filter, MAX_NUM_BANDS - 1> crossovers;
+    std::array<std::array<Filter, MAX_NUM_BANDS - 1>, MAX_NUM_BANDS - 1> allpasses;
+
+    void prepareCrossovers (const Parameters& params)
+    {
+        const juce::dsp::ProcessSpec spec { sampleRate, 1, N_CH_IN };
+        for (size_t k = 0; k + 1 < numBands; ++k)
+        {
+            crossovers[k].prepare (spec);
+            crossovers[k].setCutoffFrequency (params.xOverHz[k]);
+
+            for (size_t j = 0; j < k; ++j)
+            {
+                allpasses[j][k].setType (juce::dsp::LinkwitzRileyFilterType::allpass);
+                allpasses[j][k].prepare (spec);
+                allpasses[j][k].setCutoffFrequency (params.xOverHz[k]);
+            }
+        }
+    }
+
+    void splitBands (int channel, float input, std::array<float, MAX_NUM_BANDS>& bands)
+    {
+        auto rest = input;
+        for (size_t k = 0; k + 1 < numBands; ++k)
+        {
+            crossovers[k].processSample (channel, rest, bands[k], rest);
+            for (size_t j = 0; j < k; ++j)
+                bands[j] = allpasses[j][k].processSample (channel, bands[j]);
+        }
+        bands[numBands - 1] = rest;
+    }
+
+    // newest sample at `position`, the history runs backwards from there
+    float convolve (const std::vector<float>& history, const float* ir, int irLength) const
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < irLength; ++k)
+        {
+            const auto idx = (position - k + historyLength) % historyLength;
+            sum += ir[k] * history[static_cast<size_t> (idx)];
+        }
+        return sum;
+    }
+};
+} // namespace TestHelpers
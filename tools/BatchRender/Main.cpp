@@ -0,0 +1,370 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+/* Headless batch renderer: runs stereo front/back OC818 recordings through the PolarDesigner
+ * DSP without a DAW. Every file is streamed in blocks, so the memory used per job does not
+ * depend on the length of the recording. Only the GUI-free engine is used, so neither the
+ * plugin processor nor a message thread is needed.
+ */
+
+#include "Constants.hpp"
+#include "Conversions.hpp"
+#include "dsp/PolarDesignerDsp.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <iostream>
+
+namespace
+{
+constexpr auto usage =
+    "Usage: PolarDesignerRender --preset=<file.json> [options] <files...>\n"
+    "\n"
+    "Renders stereo front/back recordings (WAV/AIFF) to the virtual microphone signal.\n"
+    "\n"
+    "Options:\n"
+    "  --preset=<file>   PolarDesigner preset (JSON, as written by the plug-in)\n"
+    "  --out=<dir>       output directory (default: next to each input file)\n"
+    "  --suffix=<text>   appended to the output file names (default: _pd)\n"
+    "  --block=<n>       processing block size in samples (default: 4096)\n"
+    "  --jobs=<n>        number of files rendered in parallel (default: number of cores)\n";
+
+struct RenderSettings
+{
+    juce::File presetFile;
+    juce::File outputDirectory;
+    juce::String suffix = "_pd";
+    int blockSize = 4096;
+    int numJobs = juce::SystemStats::getNumCpus();
+};
+
+/* Reads a preset as written by the plug-in, the values are the plain parameter values. Band
+ * settings beyond the preset's five bands keep their defaults.
+ */
+juce::Result loadPreset (const juce::File& presetFile, PolarDesignerDsp::Parameters& params)
+{
+    using namespace juce;
+
+    var preset;
+    if (JSON::parse (presetFile.loadFileAsString(), preset).failed())
+        return Result::fail ("File could not be parsed: Please provide valid JSON!");
+
+    const auto getValue = [&preset] (const String& name, float defaultValue = 0.0f)
+    { return static_cast<float> (preset.getProperty (name, defaultValue)); };
+
+    for (const auto* name : { "nrActiveBands", "ffDfEq", "proximity" })
+        if (! preset.hasProperty (name))
+            return Result::fail ("Corrupt preset file: No '" + String (name)
+                                 + "' property found.");
+
+    const auto numBands = roundToInt (getValue ("nrActiveBands"));
+    if (numBands < 1 || numBands > static_cast<int> (MAX_NUM_EQS))
+        return Result::fail ("nrActiveBands needs to be between 1 and " + String (MAX_NUM_EQS)
+                             + ".");
+    params.numBands = static_cast<unsigned int> (numBands);
+
+    // crossovers are limited to the range of their band layout, like the plug-in does
+    for (unsigned int i = 0; i < MAX_NUM_EQS - 1; ++i)
+    {
+        const auto name = "xOverF" + String (i + 1);
+        if (! preset.hasProperty (name))
+            return Result::fail ("Corrupt preset file: No '" + name + "' property found.");
+
+        const auto normalised =
+            jlimit (0.0f, 1.0f, hzToZeroToOne (params.numBands, i, getValue (name)));
+        params.xOverHz[i] =
+            i + 1 < params.numBands ? hzFromZeroToOne (params.numBands, i, normalised) : 0.0f;
+    }
+
+    for (unsigned int i = 0; i < MAX_NUM_EQS; ++i)
+    {
+        const auto band = String (i + 1);
+        for (const auto& name : { "dirFactor" + band, "gain" + band, "solo" + band, "mute" + band })
+            if (! preset.hasProperty (name))
+                return Result::fail ("Corrupt preset file: No '" + name + "' property found.");
+
+        const auto dirFactor = getValue ("dirFactor" + band);
+        if (dirFactor < -0.5f || dirFactor > 1.0f)
+            return Result::fail ("DirFactor" + band + " needs to be between -0.5 and 1.");
+
+        params.dirFactors[i] = dirFactor;
+        params.gainsDb[i] = jlimit (-24.0f, 18.0f, getValue ("gain" + band));
+        params.solo[i] = getValue ("solo" + band) > 0.5f;
+        params.mute[i] = getValue ("mute" + band) > 0.5f;
+    }
+
+    params.eqMode = jlimit (0, 2, roundToInt (getValue ("ffDfEq")));
+    params.proximity = getValue ("proximityOnOff") > 0.5f
+                           ? jlimit (-1.0f, 1.0f, getValue ("proximity"))
+                           : 0.0f;
+    params.zeroLatency = getValue ("zeroLatencyMode") > 0.5f;
+    return Result::ok();
+}
+
+juce::File getOutputFile (const juce::File& input, const RenderSettings& settings)
+{
+    auto directory = settings.outputDirectory == juce::File() ? input.getParentDirectory()
+                                                              : settings.outputDirectory;
+
+    return directory.getChildFile (input.getFileNameWithoutExtension() + settings.suffix
+                                   + input.getFileExtension());
+}
+
+juce::Result renderFile (PolarDesignerDsp& dsp,
+                         const PolarDesignerDsp::Parameters& params,
+                         const juce::File& input,
+                         const juce::File& output,
+                         int blockSize)
+{
+    using namespace juce;
+
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (input));
+    if (reader == nullptr)
+        return Result::fail ("Unsupported audio file");
+
+    if (reader->numChannels != 2)
+        return Result::fail ("Expected a stereo front/back recording, got "
+                             + String (reader->numChannels) + " channels");
+
+    auto* format = formatManager.findFormatForFileExtension (output.getFileExtension());
+    if (format == nullptr)
+        return Result::fail ("Unsupported output format " + output.getFileExtension());
+
+    if (output.exists() && ! output.deleteFile())
+        return Result::fail ("Could not overwrite " + output.getFullPathName());
+
+    auto stream = std::make_unique<FileOutputStream> (output);
+    if (stream->failedToOpen())
+        return Result::fail ("Could not create " + output.getFullPathName());
+
+    std::unique_ptr<AudioFormatWriter> writer (
+        format->createWriterFor (stream.get(),
+                                 reader->sampleRate,
+                                 1,
+                                 static_cast<int> (reader->bitsPerSample),
+                                 {},
+                                 0));
+    if (writer == nullptr)
+        return Result::fail ("Could not create a writer for " + output.getFullPathName());
+
+    stream.release(); // owned by the writer now
+
+    // start every file from a clean state, the engine is reused between jobs. Renders wait
+    // for the filter kernels instead of running the delayed fallback while they are designed
+    // and use the long offline partitions.
+    dsp.setNonRealtime (true);
+    dsp.setProcessingQuantum (PD_OFFLINE_PROCESSING_QUANTUM);
+    dsp.setParameters (params);
+    dsp.prepare (reader->sampleRate, blockSize);
+    dsp.resetGainRamps();
+
+    // the first `latency` output samples are dropped and the tail is flushed with silence
+    // instead, so the rendered file lines up with the input
+    const auto length = reader->lengthInSamples;
+    const auto latency = static_cast<int64> (dsp.getLatencySamples (params));
+
+    AudioBuffer<float> buffer (2, blockSize);
+
+    int64 readPosition = 0;
+    int64 samplesWritten = 0;
+
+    while (samplesWritten < length)
+    {
+        const auto numSamples =
+            static_cast<int> (std::min<int64> (blockSize, length + latency - readPosition));
+        buffer.setSize (2, numSamples, false, false, true);
+        buffer.clear();
+
+        if (readPosition < length)
+        {
+            const auto numToRead =
+                static_cast<int> (std::min<int64> (numSamples, length - readPosition));
+            if (! reader->read (&buffer, 0, numToRead, readPosition, true, true))
+                return Result::fail ("Read error at sample " + String (readPosition));
+        }
+
+        dsp.process (buffer.getReadPointer (0),
+                     buffer.getReadPointer (1),
+                     buffer.getWritePointer (0),
+                     numSamples);
+
+        const auto outputPosition = readPosition - latency;
+        readPosition += numSamples;
+
+        const auto skip = static_cast<int> (std::max<int64> (0, -outputPosition));
+        const auto numToWrite =
+            static_cast<int> (std::min<int64> (numSamples - skip, length - samplesWritten));
+
+        if (numToWrite <= 0)
+            continue;
+
+        AudioBuffer<float> microphone (buffer.getArrayOfWritePointers(), 1, skip, numToWrite);
+        if (! writer->writeFromAudioSampleBuffer (microphone, 0, numToWrite))
+            return Result::fail ("Write error in " + output.getFullPathName());
+
+        samplesWritten += numToWrite;
+    }
+
+    return Result::ok();
+}
+
+RenderSettings parseSettings (const juce::ArgumentList& args, juce::Array<juce::File>& inputs)
+{
+    using namespace juce;
+
+    RenderSettings settings;
+    auto cwd = File::getCurrentWorkingDirectory();
+
+    if (! args.containsOption ("--preset"))
+        ConsoleApplication::fail ("Please specify a preset\n\n" + String (usage));
+
+    settings.presetFile = cwd.getChildFile (args.getValueForOption ("--preset"));
+    if (! settings.presetFile.existsAsFile())
+        ConsoleApplication::fail ("File not found: " + settings.presetFile.getFullPathName());
+
+    if (args.containsOption ("--out"))
+    {
+        settings.outputDirectory = cwd.getChildFile (args.getValueForOption ("--out"));
+        if (! settings.outputDirectory.createDirectory())
+            ConsoleApplication::fail ("Could not create "
+                                      + settings.outputDirectory.getFullPathName());
+    }
+
+    if (args.containsOption ("--suffix"))
+        settings.suffix = args.getValueForOption ("--suffix");
+
+    if (args.containsOption ("--block"))
+        settings.blockSize = jlimit (32, 1 << 16, args.getValueForOption ("--block").getIntValue());
+
+    if (args.containsOption ("--jobs"))
+        settings.numJobs = jmax (1, args.getValueForOption ("--jobs").getIntValue());
+
+    for (auto& arg : args.arguments)
+    {
+        if (arg.isOption())
+            continue;
+
+        auto file = arg.resolveAsFile();
+        if (! file.existsAsFile())
+            ConsoleApplication::fail ("File not found: " + file.getFullPathName());
+
+        if (getOutputFile (file, settings) == file)
+            ConsoleApplication::fail ("Output would overwrite the input, use --out or --suffix");
+
+        inputs.add (file);
+    }
+
+    if (inputs.isEmpty())
+        ConsoleApplication::fail ("No input files given\n\n" + String (usage));
+
+    settings.numJobs = jmin (settings.numJobs, inputs.size());
+    return settings;
+}
+
+int run (const juce::ArgumentList& args)
+{
+    using namespace juce;
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << usage;
+        return 0;
+    }
+
+    Array<File> inputs;
+    auto settings = parseSettings (args, inputs);
+
+    PolarDesignerDsp::Parameters params;
+    auto result = loadPreset (settings.presetFile, params);
+    if (result.failed())
+        ConsoleApplication::fail (result.getErrorMessage());
+
+    // one engine per worker thread, the filter kernels are shared between them
+    std::vector<std::unique_ptr<PolarDesignerDsp>> engines;
+    for (int i = 0; i < settings.numJobs; ++i)
+        engines.push_back (std::make_unique<PolarDesignerDsp>());
+
+    CriticalSection lock;
+    std::vector<PolarDesignerDsp*> idleEngines;
+    for (auto& engine : engines)
+        idleEngines.push_back (engine.get());
+
+    std::vector<Result> results (static_cast<size_t> (inputs.size()), Result::ok());
+    std::atomic<int> numRemaining { inputs.size() };
+    WaitableEvent finished;
+
+    ThreadPool pool (settings.numJobs);
+
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        pool.addJob (
+            [&, i]
+            {
+                PolarDesignerDsp* engine = nullptr;
+                {
+                    const ScopedLock sl (lock);
+                    jassert (! idleEngines.empty());
+                    engine = idleEngines.back();
+                    idleEngines.pop_back();
+                }
+
+                auto& input = inputs.getReference (i);
+                auto output = getOutputFile (input, settings);
+                auto result = renderFile (*engine, params, input, output, settings.blockSize);
+                results[static_cast<size_t> (i)] = result;
+
+                {
+                    const ScopedLock sl (lock);
+                    idleEngines.push_back (engine);
+
+                    if (result.wasOk())
+                        std::cout << input.getFileName() << " -> " << output.getFullPathName()
+                                  << std::endl;
+                    else
+                        std::cerr << input.getFileName() << ": " << result.getErrorMessage()
+                                  << std::endl;
+                }
+
+                if (--numRemaining == 0)
+                    finished.signal();
+            });
+    }
+
+    finished.wait();
+
+    auto numFailed =
+        std::count_if (results.begin(), results.end(), [] (auto& r) { return r.failed(); });
+
+    if (numFailed > 0)
+        ConsoleApplication::fail (String (numFailed) + " of " + String (inputs.size())
+                                  + " files failed to render");
+
+    return 0;
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+    return juce::ConsoleApplication::invokeCatchingFailures ([&] { return run (args); });
+}
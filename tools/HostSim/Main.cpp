@@ -0,0 +1,457 @@
+/*
+ ==============================================================================
+ Author: Sebastian Grill
+
+ Copyright (c) 2025 - Austrian Audio GmbH
+ www.austrian.audio
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+/* Headless replacement for the REAPER/Cubase regression projects in tests/DAW_tests: loads the
+ * built VST3 like a host does, plays the test media through it with varying block sizes,
+ * automation and state save/restore cycles, and compares the renders against gold references.
+ * The processing time of every block is recorded as well.
+ */
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <iostream>
+#include <numeric>
+
+#ifndef POLARDESIGNER_ROOT_PATH
+    #define POLARDESIGNER_ROOT_PATH ""
+#endif
+
+#ifndef POLARDESIGNER_VST3_PATH
+    #define POLARDESIGNER_VST3_PATH ""
+#endif
+
+namespace
+{
+constexpr auto usage =
+    "Usage: PolarDesignerHostSim [options]\n"
+    "\n"
+    "Replays the DAW regression matrix (1-5 bands, 48/96 kHz, zero latency) headlessly.\n"
+    "\n"
+    "Options:\n"
+    "  --plugin=<path>             VST3 bundle to test (default: the one from this build)\n"
+    "  --tests=<dir>               DAW_tests directory (default: tests/DAW_tests)\n"
+    "  --filter=<text>             only run cases whose name contains <text>\n"
+    "  --max-block=<n>             largest block the host sends (default: 1024)\n"
+    "  --create-gold-reference     write the renders to Reference/HostSim instead of comparing\n";
+
+// same threshold as the REAPER scripts use on the sox difference file
+constexpr double maxDifferenceRms = 0.0001;
+
+// a DAW hands out everything from single samples to its full buffer size
+constexpr int blockSizePattern[] = { 1024, 17, 256, 1, 480, 64, 1000, 333, 128, 512 };
+
+// state is saved and restored every few seconds, like autosave and undo snapshots do
+constexpr double stateCycleSeconds = 2.0;
+
+struct TestCase
+{
+    juce::String name;
+    double sampleRate;
+    int numBands;
+    bool zeroLatency;
+};
+
+std::vector<TestCase> getTestMatrix()
+{
+    std::vector<TestCase> cases;
+    for (auto sampleRate : { 48000.0, 96000.0 })
+    {
+        const auto rate = juce::String (juce::roundToInt (sampleRate / 1000.0)) + "kHz";
+
+        for (int bands = 1; bands <= 5; ++bands)
+            cases.push_back ({ juce::String (bands) + "Band_" + rate, sampleRate, bands, false });
+
+        cases.push_back ({ "ZeroLatency_" + rate, sampleRate, 1, true });
+    }
+    return cases;
+}
+
+struct TimingStats
+{
+    int numBlocks = 0;
+    double meanUs = 0.0, p99Us = 0.0, maxUs = 0.0, cpuPercent = 0.0;
+};
+
+TimingStats getTimingStats (std::vector<double> blockSeconds, double audioSeconds)
+{
+    TimingStats stats;
+    if (blockSeconds.empty())
+        return stats;
+
+    std::sort (blockSeconds.begin(), blockSeconds.end());
+    const auto total = std::accumulate (blockSeconds.begin(), blockSeconds.end(), 0.0);
+
+    stats.numBlocks = static_cast<int> (blockSeconds.size());
+    stats.meanUs = 1.0e6 * total / static_cast<double> (blockSeconds.size());
+    stats.p99Us = 1.0e6 * blockSeconds[(blockSeconds.size() * 99) / 100];
+    stats.maxUs = 1.0e6 * blockSeconds.back();
+    stats.cpuPercent = audioSeconds > 0.0 ? 100.0 * total / audioSeconds : 0.0;
+    return stats;
+}
+
+class HostSimulator
+{
+public:
+    HostSimulator (juce::PluginDescription desc, int maxBlock) :
+        description (std::move (desc)),
+        maxBlockSize (maxBlock)
+    {
+        formatManager.addDefaultFormats();
+    }
+
+    juce::Result render (const TestCase& testCase,
+                         const juce::File& input,
+                         juce::AudioBuffer<float>& output,
+                         TimingStats& timing)
+    {
+        using namespace juce;
+
+        AudioFormatManager audioFormats;
+        audioFormats.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader (audioFormats.createReaderFor (input));
+        if (reader == nullptr || reader->numChannels != 2)
+            return Result::fail ("Could not read stereo media " + input.getFullPathName());
+
+        String error;
+        auto plugin = formatManager.createPluginInstance (description,
+                                                          testCase.sampleRate,
+                                                          maxBlockSize,
+                                                          error);
+        if (plugin == nullptr)
+            return Result::fail ("Could not load the plugin: " + error);
+
+        auto layout = plugin->getBusesLayout();
+        layout.getMainInputChannelSet() = AudioChannelSet::stereo();
+        layout.getMainOutputChannelSet() = AudioChannelSet::stereo();
+        if (! plugin->setBusesLayout (layout))
+            return Result::fail ("Stereo in/out layout was rejected");
+
+        plugin->setNonRealtime (false);
+        plugin->prepareToPlay (testCase.sampleRate, maxBlockSize);
+
+        // parameters reach the plugin with the next process call, settle them and restart
+        // processing the way hosts react to a latency change
+        auto result = applyTestCase (*plugin, testCase);
+        if (result.failed())
+            return result;
+
+        AudioBuffer<float> buffer (2, maxBlockSize);
+        MidiBuffer midi;
+        buffer.clear();
+        plugin->processBlock (buffer, midi);
+        plugin->releaseResources();
+        plugin->prepareToPlay (testCase.sampleRate, maxBlockSize);
+
+        const auto length = reader->lengthInSamples;
+        const auto latency = static_cast<int64> (plugin->getLatencySamples());
+        const auto stateCycleLength = static_cast<int64> (stateCycleSeconds * testCase.sampleRate);
+
+        auto* alpha = findParameter (*plugin, "Polar1");
+        if (alpha == nullptr)
+            return Result::fail ("Parameter Polar1 not found");
+
+        output.setSize (1, static_cast<int> (length));
+        output.clear();
+
+        std::vector<double> blockSeconds;
+        int64 readPosition = 0;
+        int64 nextStateCycle = stateCycleLength;
+        size_t blockIndex = 0;
+
+        while (readPosition < length + latency)
+        {
+            const auto blockSize =
+                std::min (blockSizePattern[blockIndex++ % std::size (blockSizePattern)],
+                          maxBlockSize);
+            const auto numSamples =
+                static_cast<int> (std::min<int64> (blockSize, length + latency - readPosition));
+
+            buffer.setSize (2, numSamples, false, false, true);
+            buffer.clear();
+
+            if (readPosition < length)
+            {
+                const auto numToRead =
+                    static_cast<int> (std::min<int64> (numSamples, length - readPosition));
+                reader->read (&buffer, 0, numToRead, readPosition, true, true);
+            }
+
+            // automation: sweep the first band from omni to figure-of-eight over the file
+            const auto progress = static_cast<float> (readPosition) / static_cast<float> (length);
+            alpha->setValue (jlimit (0.0f, 1.0f, (0.5f + progress) / 1.5f));
+
+            if (readPosition >= nextStateCycle)
+            {
+                MemoryBlock state;
+                plugin->getStateInformation (state);
+                plugin->setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+                nextStateCycle += stateCycleLength;
+            }
+
+            const auto start = Time::getHighResolutionTicks();
+            plugin->processBlock (buffer, midi);
+            blockSeconds.push_back (
+                Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start));
+
+            // drop the latency at the start, like a host with delay compensation
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto outputPosition = readPosition + i - latency;
+                if (outputPosition >= 0 && outputPosition < length)
+                    output.setSample (0,
+                                      static_cast<int> (outputPosition),
+                                      buffer.getSample (0, i));
+            }
+
+            readPosition += numSamples;
+        }
+
+        plugin->releaseResources();
+        timing = getTimingStats (std::move (blockSeconds),
+                                 static_cast<double> (length) / testCase.sampleRate);
+        return Result::ok();
+    }
+
+private:
+    juce::AudioPluginFormatManager formatManager;
+    juce::PluginDescription description;
+    int maxBlockSize;
+
+    static juce::AudioProcessorParameter* findParameter (juce::AudioProcessor& plugin,
+                                                         const juce::String& name)
+    {
+        for (auto* parameter : plugin.getParameters())
+            if (parameter->getName (64) == name)
+                return parameter;
+
+        return nullptr;
+    }
+
+    static juce::Result applyTestCase (juce::AudioProcessor& plugin, const TestCase& testCase)
+    {
+        using namespace juce;
+
+        // nrBands is 0..4, zero latency a switch, the band patterns run from -0.5 to 1
+        const std::pair<const char*, float> values[] = {
+            { "Nr. of Bands", static_cast<float> (testCase.numBands - 1) / 4.0f },
+            { "Zero Latency", testCase.zeroLatency ? 1.0f : 0.0f },
+            { "Polar2", (0.5f + 0.5f) / 1.5f }, // cardioid
+            { "Polar3", (0.5f + 1.0f) / 1.5f }, // figure-of-eight
+            { "Polar4", (0.5f - 0.5f) / 1.5f }, // reverse cardioid
+            { "Polar5", (0.5f + 0.25f) / 1.5f },
+        };
+
+        for (const auto& [name, value] : values)
+        {
+            auto* parameter = findParameter (plugin, name);
+            if (parameter == nullptr)
+                return Result::fail ("Parameter " + String (name) + " not found");
+
+            parameter->setValueNotifyingHost (value);
+        }
+        return Result::ok();
+    }
+};
+
+double getDifferenceRms (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+{
+    if (a.getNumSamples() != b.getNumSamples())
+        return std::numeric_limits<double>::infinity();
+
+    double sum = 0.0;
+    for (int i = 0; i < a.getNumSamples(); ++i)
+    {
+        const auto difference = static_cast<double> (a.getSample (0, i) - b.getSample (0, i));
+        sum += difference * difference;
+    }
+    return std::sqrt (sum / std::max (1, a.getNumSamples()));
+}
+
+juce::Result writeWav (const juce::File& file, const juce::AudioBuffer<float>& audio, double sr)
+{
+    using namespace juce;
+
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();
+
+    auto stream = std::make_unique<FileOutputStream> (file);
+    if (stream->failedToOpen())
+        return Result::fail ("Could not create " + file.getFullPathName());
+
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer (
+        wav.createWriterFor (stream.get(), sr, 1, 32, {}, 0));
+    if (writer == nullptr)
+        return Result::fail ("Could not write " + file.getFullPathName());
+
+    stream.release(); // owned by the writer now
+    writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+    return Result::ok();
+}
+
+bool readWav (const juce::File& file, juce::AudioBuffer<float>& audio)
+{
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> reader (
+        wav.createReaderFor (file.createInputStream().release(), true));
+    if (reader == nullptr)
+        return false;
+
+    audio.setSize (1, static_cast<int> (reader->lengthInSamples));
+    return reader->read (&audio, 0, audio.getNumSamples(), 0, true, false);
+}
+
+int run (const juce::ArgumentList& args)
+{
+    using namespace juce;
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << usage;
+        return 0;
+    }
+
+    const auto cwd = File::getCurrentWorkingDirectory();
+    auto pluginFile = cwd.getChildFile (String (POLARDESIGNER_VST3_PATH));
+    if (args.containsOption ("--plugin"))
+        pluginFile = cwd.getChildFile (args.getValueForOption ("--plugin"));
+
+    auto testsDir = File (String (POLARDESIGNER_ROOT_PATH)).getChildFile ("tests/DAW_tests");
+    if (args.containsOption ("--tests"))
+        testsDir = cwd.getChildFile (args.getValueForOption ("--tests"));
+
+    const auto filter = args.getValueForOption ("--filter");
+    const auto createGoldReference = args.containsOption ("--create-gold-reference");
+
+    auto maxBlockSize = 1024;
+    if (args.containsOption ("--max-block"))
+        maxBlockSize = jlimit (32, 1 << 16, args.getValueForOption ("--max-block").getIntValue());
+
+    if (! pluginFile.exists())
+        ConsoleApplication::fail ("Plugin not found: " + pluginFile.getFullPathName());
+
+    VST3PluginFormat vst3;
+    OwnedArray<PluginDescription> descriptions;
+    vst3.findAllTypesForFile (descriptions, pluginFile.getFullPathName());
+    if (descriptions.isEmpty())
+        ConsoleApplication::fail ("No VST3 plugin in " + pluginFile.getFullPathName());
+
+    const auto referenceDir = testsDir.getChildFile ("Reference/HostSim");
+    const auto resultsDir = testsDir.getChildFile ("Results/HostSim");
+    resultsDir.createDirectory();
+
+    FileOutputStream history (testsDir.getChildFile ("Results/test_history.log"));
+    FileOutputStream timingCsv (resultsDir.getChildFile ("timing.csv"));
+    timingCsv.setPosition (0);
+    timingCsv.truncate();
+    timingCsv << "case,blocks,mean_us,p99_us,max_us,cpu_percent\n";
+
+    auto logHistory = [&history] (const String& text)
+    { history << Time::getCurrentTime().toString (true, true) << ": " << text << "\n"; };
+
+    HostSimulator host (*descriptions.getFirst(), maxBlockSize);
+    int numFailed = 0;
+
+    for (const auto& testCase : getTestMatrix())
+    {
+        if (filter.isNotEmpty() && ! testCase.name.contains (filter))
+            continue;
+
+        const auto rate = String (roundToInt (testCase.sampleRate / 1000.0)) + "kHz";
+        const auto media = testsDir.getChildFile ("Reaper/Media/PolardesignerTestfile_"
+                                                  "-3dBEIGHT_-9dBCARDIOID_-infdBOMNI_"
+                                                  + rate + ".wav");
+
+        AudioBuffer<float> rendered;
+        TimingStats timing;
+        auto result = host.render (testCase, media, rendered, timing);
+
+        const auto fileName = "hostsim_" + testCase.name + ".wav";
+        const auto referenceFile = referenceDir.getChildFile (fileName);
+
+        if (result.wasOk() && createGoldReference)
+        {
+            result = writeWav (referenceFile, rendered, testCase.sampleRate);
+            if (result.wasOk())
+                logHistory ("Created gold reference file (" + referenceFile.getFullPathName()
+                            + ")");
+        }
+        else if (result.wasOk())
+        {
+            writeWav (resultsDir.getChildFile (fileName), rendered, testCase.sampleRate);
+
+            AudioBuffer<float> reference;
+            if (! readWav (referenceFile, reference))
+            {
+                result = Result::fail ("Reference not found, run with --create-gold-reference");
+            }
+            else
+            {
+                const auto rms = getDifferenceRms (reference, rendered);
+                const auto message =
+                    String::formatted ("(RMS: %.6f, case: ", rms) + testCase.name + ")";
+
+                if (rms < maxDifferenceRms)
+                {
+                    logHistory ("Success " + message);
+                }
+                else
+                {
+                    logHistory ("Warning " + message);
+                    result = Result::fail ("Rendered output differs from reference " + message);
+                }
+            }
+        }
+
+        timingCsv << testCase.name << "," << timing.numBlocks << ","
+                  << String (timing.meanUs, 2) << "," << String (timing.p99Us, 2) << ","
+                  << String (timing.maxUs, 2) << "," << String (timing.cpuPercent, 3) << "\n";
+
+        if (result.wasOk())
+        {
+            std::cout << testCase.name << ": ok, " << String (timing.meanUs, 1) << " us/block (p99 "
+                      << String (timing.p99Us, 1) << " us, " << String (timing.cpuPercent, 2)
+                      << " % CPU)" << std::endl;
+        }
+        else
+        {
+            std::cerr << testCase.name << ": " << result.getErrorMessage() << std::endl;
+            ++numFailed;
+        }
+    }
+
+    if (numFailed > 0)
+        ConsoleApplication::fail (String (numFailed) + " host simulation cases failed");
+
+    return 0;
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    // plugin instances are created and destroyed on the message thread
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args (argc, argv);
+    return juce::ConsoleApplication::invokeCatchingFailures ([&] { return run (args); });
+}